@@ -36,12 +36,33 @@
 #ifndef SYSTEM_H_
 #define SYSTEM_H_
 
+/* Value of the tick counter. Time differences are computed with
+   unsigned arithmetic, so the counter may wrap around. */
+typedef unsigned long System_Ticks;
+
+struct ucunit_sink_s;
+struct ucunit_fd_sink_s;
+
 /* function prototypes */
 void System_Init(void);
 void System_Shutdown(void);
 void System_Safestate(void);
 void System_Recover(void);
 void System_WriteString(char * msg);
+void System_WriteString_P(const char * msg);
 void System_WriteInt(int n);
+void System_WriteByte(unsigned char b);
+void System_WriteBuffer(const char * buffer, int length);
+void System_FdSinkInit(struct ucunit_fd_sink_s * sink, int fd);
+struct ucunit_sink_s * System_OpenReport(const char * path);
+void System_ReadCommand(int argc, char * argv[], char * buffer, int size);
+int System_RunParallel(const char * filter, int jobs);
+int System_RunProtected(void (*function)(void));
+int System_LoadPersistent(void * buffer, int size);
+void System_SavePersistent(const void * buffer, int size);
+void System_StartTimeout(unsigned long ms);
+void System_StopTimeout(void);
+System_Ticks System_GetTicks(void);
+unsigned long System_GetTicksPerSecond(void);
 
 #endif /* SYSTEM_H_ */
@@ -38,7 +38,7 @@
 #include "uCUnit-v1.0.h"
 #include "Testsuite.h"
 
-static void Test_BasicChecksDemo(void)
+UCUNIT_TEST(Test_BasicChecksDemo, "demo")
 {
     char * s = NULL;
     int a = 0;
@@ -58,7 +58,7 @@ static void Test_BasicChecksDemo(void)
     UCUNIT_TestcaseEnd();
 }
 
-static void Test_PointersDemo(void)
+UCUNIT_TEST(Test_PointersDemo, "demo")
 {
     char * s = NULL;
 
@@ -80,7 +80,7 @@ static void Test_PointersDemo(void)
     UCUNIT_TestcaseEnd(); /* Pass */
 }
 
-static void Test_ChecklistDemo(void)
+UCUNIT_TEST(Test_ChecklistDemo, "demo")
 {
     int a = 0;
     int b = 0;
@@ -103,7 +103,7 @@ static void Test_ChecklistDemo(void)
     UCUNIT_TestcaseEnd(); /* Fail */
 }
 
-static void Test_BitChecksDemo(void)
+UCUNIT_TEST(Test_BitChecksDemo, "demo")
 {
     UCUNIT_TestcaseBegin("DEMO:Checking Bits");
 
@@ -119,7 +119,7 @@ static void Test_BitChecksDemo(void)
     UCUNIT_TestcaseEnd(); /* Fail */
 }
 
-static void Test_CheckTracepointsDemo(void)
+UCUNIT_TEST(Test_CheckTracepointsDemo, "demo tracepoints")
 {
 
     int found = FALSE;
@@ -138,6 +138,7 @@ static void Test_CheckTracepointsDemo(void)
 
     UCUNIT_CheckTracepointCoverage(0); /* Pass */
     UCUNIT_CheckTracepointCoverage(1); /* Pass */
+    UCUNIT_CheckTracepointRangeCoverage(0, 1); /* Pass */
 
     UCUNIT_ResetTracepointCoverage();
     for (i = 0; (i < 50) && (!found); i++)
@@ -164,35 +165,258 @@ static void Test_CheckTracepointsDemo(void)
     UCUNIT_CheckTracepointCoverage(0); /* Fail  */
     UCUNIT_CheckTracepointCoverage(1); /* Pass */
     UCUNIT_CheckTracepointCoverage(2); /* Fail */
+    UCUNIT_CheckTracepointRangeCoverage(0, 2); /* Fail */
+    UCUNIT_WriteTracepointCoverage(0, 2);
 
     UCUNIT_TestcaseEnd(); /* Fail */
 }
 
-void Testsuite_RunTests(void)
+#ifdef UCUNIT_TRACEPOINT_TIMESTAMPS
+UCUNIT_TEST(Test_LatencyDemo, "demo timing")
 {
-    Test_BasicChecksDemo();
-    Test_PointersDemo();
-    Test_ChecklistDemo();
-    Test_BitChecksDemo();
-    Test_CheckTracepointsDemo();
+    volatile int sum = 0;
+    int i = 0;
+
+    UCUNIT_TestcaseBegin("DEMO:Latencies");
+
+    UCUNIT_ResetTrace();
+    for (i = 0; i < 4; i++)
+    {
+        UCUNIT_Tracepoint(3);
+        sum += i;
+        UCUNIT_Tracepoint(4);
+    }
+
+    UCUNIT_CheckLatencyBetween(3, 4, UCUNIT_GetTicksPerSecond()); /* Pass */
+    UCUNIT_CheckLatencyBetween(4, 5, UCUNIT_GetTicksPerSecond()); /* Fail, 5 never reached */
+    UCUNIT_WriteTraceReport();
+
+    UCUNIT_TestcaseEnd(); /* Fail */
+}
+#endif
+
+UCUNIT_TEST(Test_BenchmarkDemo, "demo timing")
+{
+    volatile int sum = 0;
+    int i = 0;
+
+    UCUNIT_TestcaseBegin("DEMO:Benchmarks");
+
+    /* Measure a statement 100 times */
+    UCUNIT_Benchmark("Sum of 0..99", 100, for (i = 0; i < 100; i++) { sum += i; });
+
+    /* Measure a block of code */
+    UCUNIT_BenchmarkBegin();
+    for (i = 0; i < 1000; i++)
+    {
+        sum += i;
+    }
+    UCUNIT_BenchmarkEnd();
+    UCUNIT_BenchmarkReport("Sum of 0..999");
+
+    UCUNIT_TestcaseEnd(); /* Pass */
+}
+
+UCUNIT_TEST(Test_TimingDemo, "demo timing")
+{
+    volatile int sum = 0;
+    int i = 0;
+
+    /* The whole testcase must finish within one second */
+    UCUNIT_TestcaseBeginDeadline("DEMO:Timing budgets", UCUNIT_MicrosecondsToTicks(1000000));
+
+    UCUNIT_CheckDurationBelowUs(100000, for (i = 0; i < 100; i++) { sum += i; }); /* Pass */
+    UCUNIT_CheckDurationBelow(UCUNIT_GetTicksPerSecond(), sum = 0); /* Pass */
+
+    UCUNIT_TestcaseEnd(); /* Pass */
+}
+
+static int Test_NextValue(int * counter)
+{
+    return ++(*counter);
+}
+
+UCUNIT_TEST(Test_TypedChecksDemo, "demo")
+{
+    int counter = 0;
+    unsigned long mask = 0xFFFFFFFFUL;
+    char buffer[4];
+
+    UCUNIT_TestcaseBegin("DEMO:Typed checks");
+
+    /* Each operand is evaluated once */
+    UCUNIT_CheckIntEq(1, Test_NextValue(&counter)); /* Pass */
+    UCUNIT_CheckIntEq(1, counter); /* Pass */
+    UCUNIT_CheckIntLt(-1, counter); /* Pass */
+    UCUNIT_CheckUIntGe(mask, 0x80000000UL); /* Pass */
+    UCUNIT_CheckPtrLt(&buffer[0], &buffer[3]); /* Pass */
+#ifdef UCUNIT_HAVE_INT64
+    UCUNIT_CheckInt64Ne(-1LL, 0x100000000LL); /* Pass */
+#endif
+    UCUNIT_CheckIntGt(counter, 2); /* Fail, writes [1, 2] */
+
+    UCUNIT_TestcaseEnd(); /* Fail */
+}
+
+UCUNIT_TEST(Test_FormatDemo, "demo")
+{
+    char buffer[UCUNIT_FORMAT_BUFFER_SIZE];
+
+    UCUNIT_TestcaseBegin("DEMO:Formatting");
+
+    /* Boundaries of the 32-bit formatters */
+    UCUNIT_CheckIntEq(10, UCUNIT_FormatU32(buffer, 0xFFFFFFFFUL)); /* Pass */
+    UCUNIT_CheckMemEqual("4294967295", buffer, 11); /* Pass */
+    UCUNIT_CheckIntEq(11, UCUNIT_FormatS32(buffer, -2147483647L - 1)); /* Pass */
+    UCUNIT_CheckMemEqual("-2147483648", buffer, 12); /* Pass */
+    UCUNIT_CheckIntEq(8, UCUNIT_FormatHex32(buffer, 0xFFFFFFFFUL, 2)); /* Pass */
+    UCUNIT_CheckMemEqual("FFFFFFFF", buffer, 9); /* Pass */
+    UCUNIT_CheckIntEq(1, UCUNIT_FormatU32(buffer, 0)); /* Pass */
+    UCUNIT_CheckMemEqual("0", buffer, 2); /* Pass */
+#ifdef UCUNIT_HAVE_INT64
+    UCUNIT_CheckIntEq(20, UCUNIT_FormatU64(buffer, 0xFFFFFFFFFFFFFFFFULL)); /* Pass */
+    UCUNIT_CheckMemEqual("18446744073709551615", buffer, 21); /* Pass */
+    UCUNIT_CheckIntEq(20, UCUNIT_FormatS64(buffer, -9223372036854775807LL - 1)); /* Pass */
+    UCUNIT_CheckMemEqual("-9223372036854775808", buffer, 21); /* Pass */
+#endif
+
+    UCUNIT_TestcaseEnd(); /* Pass */
+}
+
+UCUNIT_TEST(Test_MemoryChecksDemo, "demo memory")
+{
+    unsigned char expected[100];
+    unsigned char actual[100];
+    int i;
+
+    UCUNIT_TestcaseBegin("DEMO:Memory checks");
+
+    for (i = 0; i < 100; i++)
+    {
+        expected[i] = (unsigned char)i;
+        actual[i] = (unsigned char)i;
+    }
+    UCUNIT_CheckMemEqual(expected, actual, sizeof(actual)); /* Pass */
+
+    actual[42] = 0xFF;
+    UCUNIT_CheckMemEqual(expected, actual, sizeof(actual)); /* Fail at 42 */
+
+    for (i = 0; i < 100; i++)
+    {
+        actual[i] = 0xA5;
+    }
+    UCUNIT_CheckMemFill(actual, 0xA5, sizeof(actual)); /* Pass */
+
+    UCUNIT_TestcaseEnd(); /* Fail */
+}
 
+UCUNIT_TEST(Test_CrcChecksDemo, "demo memory")
+{
+    static const char check[] = "123456789";
+    unsigned char block[64];
+    int i;
+
+    UCUNIT_TestcaseBegin("DEMO:CRC checks");
+
+    UCUNIT_CheckCrc32Equal(check, 9, 0xCBF43926UL); /* Pass */
+
+    /* Digest of 4 KB of generated data, checked in blocks */
+    UCUNIT_DigestBegin();
+    for (i = 0; i < 64; i++)
+    {
+        int k;
+
+        for (k = 0; k < 64; k++)
+        {
+            block[k] = (unsigned char)(i + k);
+        }
+        UCUNIT_DigestUpdate(block, sizeof(block));
+    }
+    UCUNIT_DigestCheck(0x2491E878UL); /* Pass */
+
+    UCUNIT_TestcaseEnd(); /* Pass */
+}
+
+UCUNIT_TEST(Test_FloatChecksDemo, "demo float")
+{
+    ucunit_q15_t q15_expected[32];
+    ucunit_q15_t q15_actual[32];
+    ucunit_q31_t q31_value = 0x40000000L;
+#ifndef UCUNIT_NO_FLOAT
+    float expected[32];
+    float actual[32];
+    float third = 1.0f / 3.0f;
+#endif
+    int i;
+
+    UCUNIT_TestcaseBegin("DEMO:Floating point checks");
+
+    for (i = 0; i < 32; i++)
+    {
+        q15_expected[i] = (ucunit_q15_t)(i * 1000 - 16000);
+        q15_actual[i] = (ucunit_q15_t)(q15_expected[i] + (i & 1));
+#ifndef UCUNIT_NO_FLOAT
+        expected[i] = (float)i * 0.25f;
+        actual[i] = expected[i] + 0.0001f;
+#endif
+    }
+    UCUNIT_CheckQ15IsNear(q15_expected[1], q15_actual[1], 1); /* Pass */
+    UCUNIT_CheckQ31IsNear(0x40000000L, q31_value + 3, 4); /* Pass */
+    UCUNIT_CheckQ15ArrayIsNear(q15_expected, q15_actual, 32, 1); /* Pass */
+
+#ifndef UCUNIT_NO_FLOAT
+    UCUNIT_CheckIsNear(1.0, third * 3.0f, 1e-6); /* Pass */
+    UCUNIT_CheckIsNearUlp(0.1f, 0.3f - 0.2f, 4); /* Pass */
+    UCUNIT_CheckArrayIsNear(expected, actual, 32, 0.001f); /* Pass */
+
+    actual[17] += 0.5f;
+    UCUNIT_CheckArrayIsNear(expected, actual, 32, 0.001f); /* Fail at 17 */
+#endif
+
+    UCUNIT_TestcaseEnd(); /* Fail */
+}
+
+UCUNIT_TestTableBegin()
+    UCUNIT_TestTableEntry(Test_BasicChecksDemo)
+    UCUNIT_TestTableEntry(Test_PointersDemo)
+    UCUNIT_TestTableEntry(Test_ChecklistDemo)
+    UCUNIT_TestTableEntry(Test_BitChecksDemo)
+    UCUNIT_TestTableEntry(Test_CheckTracepointsDemo)
+#ifdef UCUNIT_TRACEPOINT_TIMESTAMPS
+    UCUNIT_TestTableEntry(Test_LatencyDemo)
+#endif
+    UCUNIT_TestTableEntry(Test_BenchmarkDemo)
+    UCUNIT_TestTableEntry(Test_TimingDemo)
+    UCUNIT_TestTableEntry(Test_TypedChecksDemo)
+    UCUNIT_TestTableEntry(Test_FormatDemo)
+    UCUNIT_TestTableEntry(Test_MemoryChecksDemo)
+    UCUNIT_TestTableEntry(Test_CrcChecksDemo)
+    UCUNIT_TestTableEntry(Test_FloatChecksDemo)
+UCUNIT_TestTableEnd()
+
+void Testsuite_RunTests(const char * command)
+{
+    UCUNIT_RunTests(command);
     UCUNIT_WriteSummary();
 }
 
-int main(void)
+int main(int argc, char * argv[])
 {
+    char command[UCUNIT_COMMAND_SIZE];
+
     UCUNIT_Init();
-    UCUNIT_WriteString("\n**************************************");
-    UCUNIT_WriteString("\nName:     ");
-    UCUNIT_WriteString("uCUnit demo application");
-    UCUNIT_WriteString("\nCompiled: ");
+    UCUNIT_WriteString_P(UCUNIT_PSTR("\n**************************************"));
+    UCUNIT_WriteString_P(UCUNIT_PSTR("\nName:     "));
+    UCUNIT_WriteString_P(UCUNIT_PSTR("uCUnit demo application"));
+    UCUNIT_WriteString_P(UCUNIT_PSTR("\nCompiled: "));
     UCUNIT_WriteString(__DATE__);
-    UCUNIT_WriteString("\nTime:     ");
+    UCUNIT_WriteString_P(UCUNIT_PSTR("\nTime:     "));
     UCUNIT_WriteString(__TIME__);
-    UCUNIT_WriteString("\nVersion:  ");
+    UCUNIT_WriteString_P(UCUNIT_PSTR("\nVersion:  "));
     UCUNIT_WriteString(UCUNIT_VERSION);
-    UCUNIT_WriteString("\n**************************************");
-    Testsuite_RunTests();
+    UCUNIT_WriteString_P(UCUNIT_PSTR("\n**************************************"));
+    UCUNIT_ReadCommand(argc, argv, command, sizeof(command));
+    Testsuite_RunTests(command);
     UCUNIT_Shutdown();
 
     return 0;
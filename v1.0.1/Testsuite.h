@@ -36,6 +36,6 @@
 #ifndef TESTSUITE_H_
 #define TESTSUITE_H_
 
-void Testsuite_RunTests(void);
+void Testsuite_RunTests(const char * command);
 
 #endif /* TESTSUITE_H_ */
@@ -4,7 +4,7 @@ PATH=D:\GNUARM\bin;%PATH%
 ECHO 'Cleaning up...'
 DEL Testsuite.elf
 ECHO 'Compiling...'
-arm-elf-gcc -mcpu=arm7tdmi -mthumb -g -o"Testsuite.elf" ../Testsuite.c System.c
+arm-elf-gcc -mcpu=arm7tdmi -mthumb -g -o"Testsuite.elf" ../Testsuite.c ../uCUnit-v1.0.c System.c
 ECHO 'Running...'
 arm-elf-run Testsuite.elf
 ENDLOCAL
@@ -36,11 +36,30 @@
  */
 #include <stdio.h>
 #include <stdlib.h>
+#include <time.h>
 #include "../System.h"
+#include "../uCUnit-v1.0.h"
+
+#if defined(__ARM_ARCH_7M__) || defined(__ARM_ARCH_7EM__)
+/* Cortex-M3/M4: cycle counter of the data watchpoint and trace unit */
+#define DEMCR      (*(volatile unsigned long *)0xE000EDFCUL)
+#define DWT_CTRL   (*(volatile unsigned long *)0xE0001000UL)
+#define DWT_CYCCNT (*(volatile unsigned long *)0xE0001004UL)
+
+/* Core clock in Hz */
+#ifndef SYSTEM_CPU_CLOCK
+#define SYSTEM_CPU_CLOCK 72000000UL
+#endif
+#endif
 
 /* Stub: Initialize your hardware here */
 void System_Init(void)
 {
+#if defined(__ARM_ARCH_7M__) || defined(__ARM_ARCH_7EM__)
+	DEMCR |= (1UL << 24); /* Enable trace */
+	DWT_CYCCNT = 0;
+	DWT_CTRL |= 1UL; /* Enable cycle counter */
+#endif
 
 	printf("Init of hardware finished.\n");
 }
@@ -48,6 +67,9 @@ void System_Init(void)
 /* Stub: Shutdown your hardware here */
 void System_Shutdown(void)
 {
+#if defined(UCUNIT_CAPTURE) && !defined(UCUNIT_CAPTURE_NO_DUMP)
+	UCUNIT_DumpCapture();
+#endif
 
 	/* asm("\tSTOP"); */
 	printf("System shutdown.\n");
@@ -66,6 +88,10 @@ void System_Recover(void)
 /* Stub: Put system in a safe state */
 void System_Safestate(void)
 {
+#if defined(UCUNIT_CAPTURE) && !defined(UCUNIT_CAPTURE_NO_DUMP)
+	UCUNIT_DumpCapture();
+#endif
+
 	/* Disable all port pins */
 	/* PORTA = 0x0000; */
 	/* PORTB = 0x0000; */
@@ -86,7 +112,115 @@ void System_WriteString(char * msg)
 	printf(msg);
 }
 
+/* Stub: Transmit a string from program memory. It is in RAM here. */
+void System_WriteString_P(const char * msg)
+{
+	System_WriteString((char *)msg);
+}
+
 void System_WriteInt(int n)
 {
-	printf("%i", n);
+	char buffer[UCUNIT_FORMAT_BUFFER_SIZE];
+
+	UCUNIT_FormatS32(buffer, n);
+	System_WriteString(buffer);
+}
+
+/* Stub: Transmit a raw byte to the host/debugger/simulator */
+void System_WriteByte(unsigned char b)
+{
+	putchar(b);
+}
+
+/* Stub: Transmit a buffer of characters to the host/debugger/simulator */
+void System_WriteBuffer(const char * buffer, int length)
+{
+	fwrite(buffer, 1, (size_t)length, stdout);
+}
+
+/* Copies the command line arguments, separated by blanks */
+void System_ReadCommand(int argc, char * argv[], char * buffer, int size)
+{
+	int length = 0;
+	int n;
+
+	for (n = 1; n < argc; n++)
+	{
+		char * arg = argv[n];
+
+		if ((n > 1) && (length < size - 1))
+		{
+			buffer[length++] = ' ';
+		}
+		while (*arg && (length < size - 1))
+		{
+			buffer[length++] = *arg++;
+		}
+	}
+	buffer[length] = 0;
+}
+
+#if defined(__ARM_ARCH_7M__) || defined(__ARM_ARCH_7EM__)
+System_Ticks System_GetTicks(void)
+{
+	return (System_Ticks)DWT_CYCCNT;
+}
+
+unsigned long System_GetTicksPerSecond(void)
+{
+	return SYSTEM_CPU_CLOCK;
+}
+#else
+/* The ARM7TDMI has no cycle counter. Use a hardware timer of your
+   device here. arm-elf-run provides the clock of the host. */
+System_Ticks System_GetTicks(void)
+{
+	return (System_Ticks)clock();
+}
+
+unsigned long System_GetTicksPerSecond(void)
+{
+	return (unsigned long)CLOCKS_PER_SEC;
+}
+#endif
+
+#ifdef UCUNIT_PERSIST_SYSTEM
+/* Stub: Read the progress record from EEPROM or flash */
+int System_LoadPersistent(void * buffer, int size)
+{
+	(void)buffer;
+	(void)size;
+	return 0;
+}
+
+/* Stub: Write the progress record to EEPROM or flash */
+void System_SavePersistent(const void * buffer, int size)
+{
+	(void)buffer;
+	(void)size;
+}
+#endif
+
+#ifdef UCUNIT_TIMEOUTS
+/* Stub: Start the watchdog or a timer which resets the system after ms
+   milliseconds. UCUNIT_PERSIST reports the testcase after the reset. */
+void System_StartTimeout(unsigned long ms)
+{
+	(void)ms;
+}
+
+/* Stub: Stop the watchdog or timer of System_StartTimeout() */
+void System_StopTimeout(void)
+{
+}
+#endif
+
+#ifdef UCUNIT_REPORTERS
+/* Stub: Open a file for the report of --report=tap:path, NULL if the
+   target has no files. The report goes to the output then. */
+ucunit_sink_t * System_OpenReport(const char * path)
+{
+	(void)path;
+	return NULL;
 }
+#endif
@@ -36,23 +36,224 @@
  */
 
 #include <avr/io.h>
+#include <avr/interrupt.h>
+#include <avr/eeprom.h>
+#include <avr/wdt.h>
+#include <util/atomic.h>
 
 #include <stdio.h>
 #include <stdlib.h>
 #include "../System.h"
+#include "../uCUnit-v1.0.h"
+
+/* Baudrate of the serial port */
+#ifndef SYSTEM_BAUDRATE
+#define SYSTEM_BAUDRATE 9600UL
+#endif
+
+/* Size of the transmit buffer. Must be a power of 2 and <= 256. */
+#ifndef SYSTEM_TX_BUFFER_SIZE
+#define SYSTEM_TX_BUFFER_SIZE 64
+#endif
+
+/* Overflow policy if the transmit buffer is full */
+#define SYSTEM_TX_BLOCK         0 /* Wait until the ISR has sent a character */
+#define SYSTEM_TX_DROP_OLDEST   1 /* Overwrite the oldest character */
+#define SYSTEM_TX_COUNT_DROPPED 2 /* Discard the new character and count it */
+
+#ifndef SYSTEM_TX_POLICY
+#define SYSTEM_TX_POLICY SYSTEM_TX_BLOCK
+#endif
+
+#if (SYSTEM_TX_BUFFER_SIZE > 256) || \
+    (SYSTEM_TX_BUFFER_SIZE & (SYSTEM_TX_BUFFER_SIZE - 1))
+#error "SYSTEM_TX_BUFFER_SIZE must be a power of 2 and <= 256"
+#endif
+
+#define SYSTEM_TX_MASK (SYSTEM_TX_BUFFER_SIZE - 1)
+
+/* Max. time to wait for each character of a command in ms */
+#ifndef SYSTEM_COMMAND_TIMEOUT
+#define SYSTEM_COMMAND_TIMEOUT 2000UL
+#endif
+
+/* Watchdog period of a testcase timeout. It must be longer than
+   a Timer1 overflow, the reset comes up to this late. */
+#ifndef SYSTEM_WATCHDOG_PERIOD
+#define SYSTEM_WATCHDOG_PERIOD WDTO_250MS
+#endif
+
+/* Transmit ring buffer. uart_putc() writes at tx_head,
+   the data register empty ISR reads at tx_tail. */
+static volatile unsigned char tx_buffer[SYSTEM_TX_BUFFER_SIZE];
+static volatile unsigned char tx_head = 0;
+static volatile unsigned char tx_tail = 0;
+static volatile unsigned char tx_active = 0; /* A character was sent */
+static volatile unsigned int tx_dropped = 0; /* Number of dropped characters */
+
+/* Sends the oldest character of the buffer. Call with interrupts disabled. */
+static void uart_send(void)
+{
+	UDR = tx_buffer[tx_tail];
+	UCSRA |= (1 << TXC); /* Clear transmit complete flag */
+	tx_tail = (tx_tail + 1) & SYSTEM_TX_MASK;
+	tx_active = 1;
+}
+
+/* Sends the oldest character by polling. Used if interrupts are disabled. */
+static void uart_poll(void)
+{
+	while (!(UCSRA & (1 << UDRE)))
+	{
+		/* wait until sending is possible */
+	}
+	uart_send();
+}
+
+/* Upper 16 bits of the tick counter, Timer1 holds the lower 16 bits */
+static volatile unsigned int timer1_overflows = 0;
+
+/* Timer1 overflows until the testcase timeout expires. While it is
+   not 0, the ISR keeps the watchdog from resetting the system. */
+static volatile unsigned long timeout_overflows = 0;
+
+ISR(TIMER1_OVF_vect)
+{
+	timer1_overflows++;
+	if (timeout_overflows)
+	{
+		timeout_overflows--;
+		wdt_reset();
+	}
+}
+
+/* Timer1 runs with the CPU clock for cycle accurate timing */
+void timer_init(void)
+{
+	TCCR1A = 0;
+	TCCR1B = (1 << CS10); /* No prescaler */
+	TIMSK |= (1 << TOIE1);
+}
+
+/* Data register empty: send the next character of the buffer */
+ISR(USART_UDRE_vect)
+{
+	if (tx_head != tx_tail)
+	{
+		uart_send();
+	}
+	else
+	{
+		UCSRB &= ~(1 << UDRIE); /* Buffer empty, stop interrupt */
+	}
+}
+
+void uart_init(void)
+{
+	unsigned int ubrr = (unsigned int)(F_CPU / (16UL * SYSTEM_BAUDRATE) - 1);
+
+	UBRRH = (unsigned char)(ubrr >> 8);
+	UBRRL = (unsigned char)ubrr;
+	UCSRB = (1 << TXEN) | (1 << RXEN);
+	UCSRC = (1 << URSEL) | (1 << UCSZ1) | (1 << UCSZ0); /* 8N1 */
+	sei();
+}
+
+void uart_putc(char c)
+{
+	unsigned char head = (tx_head + 1) & SYSTEM_TX_MASK;
+
+	if (head == tx_tail)
+	{
+		/* Buffer full */
+#if SYSTEM_TX_POLICY == SYSTEM_TX_BLOCK
+		if (SREG & (1 << SREG_I))
+		{
+			while (head == tx_tail)
+			{
+				/* wait until the ISR has sent a character */
+			}
+		}
+		else
+		{
+			uart_poll();
+		}
+#elif SYSTEM_TX_POLICY == SYSTEM_TX_DROP_OLDEST
+		ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+		{
+			if (head == tx_tail)
+			{
+				tx_tail = (tx_tail + 1) & SYSTEM_TX_MASK;
+				tx_dropped++;
+			}
+		}
+#else
+		tx_dropped++;
+		return;
+#endif
+	}
+
+	tx_buffer[tx_head] = c;
+	tx_head = head;
+	UCSRB |= (1 << UDRIE); /* Start sending in the ISR */
+}
+
+/* Waits until all characters of the buffer are sent */
+void uart_flush(void)
+{
+	while (tx_head != tx_tail)
+	{
+		if (!(SREG & (1 << SREG_I)))
+		{
+			uart_poll();
+		}
+	}
+
+	if (tx_active)
+	{
+		while (!(UCSRA & (1 << TXC)))
+		{
+			/* wait until the last character has left the shift register */
+		}
+	}
+}
+
+/* Flushes the transmit buffer and reports lost characters */
+static void flush_output(void)
+{
+	unsigned int dropped = tx_dropped;
+
+	if (dropped)
+	{
+		tx_dropped = 0;
+		System_WriteString_P(UCUNIT_PSTR("\nTransmit buffer overflow, dropped: "));
+		System_WriteInt((int)dropped);
+		System_WriteString_P(UCUNIT_PSTR("\n"));
+	}
+	uart_flush();
+}
 
 /* Stub: Initialize your hardware here */
 void System_Init(void)
 {
-	printf("Init of hardware finished.\n");
+	/* The watchdog stays on after a watchdog reset */
+	MCUCSR &= ~(1 << WDRF);
+	wdt_disable();
+	timer_init();
+	uart_init();
+	System_WriteString_P(UCUNIT_PSTR("Init of hardware finished.\n"));
 }
 
 /* Stub: Shutdown your hardware here */
 void System_Shutdown(void)
 {
+#if defined(UCUNIT_CAPTURE) && !defined(UCUNIT_CAPTURE_NO_DUMP)
+	UCUNIT_DumpCapture();
+#endif
 
 	/* asm("\tSTOP"); */
-	printf("System shutdown.\n");
+	System_WriteString_P(UCUNIT_PSTR("System shutdown.\n"));
+	flush_output();
 	exit(0);
 }
 
@@ -61,13 +262,18 @@ void System_Reset(void)
 {
 	/* Stub: Reset the hardware */
 	/* asm("\tRESET"); */
-	printf("System reset.\n");
+	System_WriteString_P(UCUNIT_PSTR("System reset.\n"));
+	flush_output();
 	exit(0);
 }
 
 /* Stub: Put system in a safe state */
 void System_Safestate(void)
 {
+#if defined(UCUNIT_CAPTURE) && !defined(UCUNIT_CAPTURE_NO_DUMP)
+	UCUNIT_DumpCapture();
+#endif
+
 	/* Disable all port pins */
 	/* PORTA = 0x0000; */
 	/* PORTB = 0x0000; */
@@ -78,33 +284,167 @@ void System_Safestate(void)
 
 	/* Put processor into idle state */
 	/* asm("\tIDLE"); */
-	printf("System safe state.\n");
+	System_WriteString_P(UCUNIT_PSTR("System safe state.\n"));
+	flush_output();
 	exit(0);
 }
 
-void uart_putc(char c)
+/* Stub: Transmit a string to the host/debugger/simulator */
+void System_WriteString(char * s)
 {
-	while (!(UCSRA & (1 << UDRE)))
+	while(*s)
 	{
-		/* wait until sending is possible */
+		uart_putc(*s);
+		s++;
 	}
-
-	UDR = c; /* Writes c to the serial port */
 }
 
-
-/* Stub: Transmit a string to the host/debugger/simulator */
-void System_WriteString(char * s)
+/* Transmit a string from flash, see UCUNIT_PSTR() */
+void System_WriteString_P(const char * s)
 {
-	while(*s)
+#ifdef UCUNIT_PROGMEM_STRINGS
+	char c;
+
+	while ((c = (char)pgm_read_byte(s)) != 0)
 	{
-		uart_putc(*s);
+		uart_putc(c);
 		s++;
 	}
+#else
+	System_WriteString((char *)s);
+#endif
 }
 
 void System_WriteInt(int n)
 {
-	/* printf("%i", n); */
+	char buffer[UCUNIT_FORMAT_BUFFER_SIZE];
+
+	UCUNIT_FormatS32(buffer, n);
+	System_WriteString(buffer);
+}
+
+void System_WriteByte(unsigned char b)
+{
+	uart_putc(b);
+}
+
+/* Transmit a buffer of characters, the UART sink of UCUNIT_SINKS */
+void System_WriteBuffer(const char * buffer, int length)
+{
+	while (length-- > 0)
+	{
+		uart_putc(*buffer++);
+	}
+}
+
+/* Receives a character by polling, returns -1 after timeout ticks */
+static int uart_getc(unsigned long timeout)
+{
+	System_Ticks start = System_GetTicks();
+
+	while (!(UCSRA & (1 << RXC)))
+	{
+		if ((System_GetTicks() - start) > timeout)
+		{
+			return -1;
+		}
+	}
+	return UDR;
+}
+
+/* Reads a command line from the UART. The host sends it after the
+   prompt, the command is empty if nothing arrives in time. */
+void System_ReadCommand(int argc, char * argv[], char * buffer, int size)
+{
+	unsigned long timeout = F_CPU / 1000UL * SYSTEM_COMMAND_TIMEOUT;
+	int length = 0;
+	int c;
+
+	(void)argc;
+	(void)argv;
+	System_WriteString_P(UCUNIT_PSTR("\nCommand: "));
+	uart_flush();
+	while (((c = uart_getc(timeout)) >= 0) && ('\r' != c) && ('\n' != c))
+	{
+		if (length < size - 1)
+		{
+			buffer[length++] = (char)c;
+		}
+	}
+	buffer[length] = 0;
+	System_WriteString(buffer);
+}
+
+System_Ticks System_GetTicks(void)
+{
+	unsigned int high;
+	unsigned int low;
+
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		high = timer1_overflows;
+		low = TCNT1;
+		if ((TIFR & (1 << TOV1)) && (low < 0x8000))
+		{
+			high++; /* Overflow not yet handled by the ISR */
+		}
+	}
+	return ((System_Ticks)high << 16) | low;
+}
+
+unsigned long System_GetTicksPerSecond(void)
+{
+	return F_CPU;
+}
+
+#ifdef UCUNIT_PERSIST_SYSTEM
+/* The progress record of UCUNIT_PERSIST is kept in the EEPROM */
+#ifndef SYSTEM_PERSIST_ADDRESS
+#define SYSTEM_PERSIST_ADDRESS 0
+#endif
+
+int System_LoadPersistent(void * buffer, int size)
+{
+	eeprom_read_block(buffer, (const void *)SYSTEM_PERSIST_ADDRESS, (size_t)size);
+	return 1;
 }
 
+/* Only the changed bytes are written, this spares the EEPROM cells */
+void System_SavePersistent(const void * buffer, int size)
+{
+	eeprom_update_block(buffer, (void *)SYSTEM_PERSIST_ADDRESS, (size_t)size);
+}
+#endif
+
+#ifdef UCUNIT_TIMEOUTS
+/* The watchdog resets the system when the timeout expires.
+   UCUNIT_PERSIST reports the testcase and continues the run. */
+void System_StartTimeout(unsigned long ms)
+{
+	unsigned long overflows = (ms * (F_CPU / 1000UL) + 0xFFFFUL) >> 16;
+
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		timeout_overflows = overflows + 1;
+	}
+	wdt_enable(SYSTEM_WATCHDOG_PERIOD);
+}
+
+void System_StopTimeout(void)
+{
+	wdt_disable();
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		timeout_overflows = 0;
+	}
+}
+#endif
+
+#ifdef UCUNIT_REPORTERS
+/* There are no files, the report goes to the UART */
+ucunit_sink_t * System_OpenReport(const char * path)
+{
+	(void)path;
+	return NULL;
+}
+#endif
@@ -1,3 +1,3 @@
 del Testsuite.exe
-gcc -march=i386 -o Testsuite.exe ./System.c ../Testsuite.c
+gcc -march=i386 -o Testsuite.exe ./System.c ../Testsuite.c ../uCUnit-v1.0.c
 Testsuite.exe
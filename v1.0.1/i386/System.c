@@ -33,13 +33,35 @@
  * If you cannot obtain a copy of the License, please contact the
  * author.
  */
+#ifndef _WIN32
+#define _XOPEN_SOURCE 600
+#endif
+
 #include <stdio.h>
 #include <stdlib.h>
+#ifdef _WIN32
+#include <io.h>
+#include <fcntl.h>
+#include <windows.h>
+#else
+#include <time.h>
+#include <signal.h>
+#include <setjmp.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#endif
 #include "../System.h"
+#include "../uCUnit-v1.0.h"
 
 /* Stub: Initialize your hardware here */
 void System_Init(void)
 {
+#ifdef _WIN32
+	/* Keep binary records of UCUNIT_MODE_TOKENIZED unchanged */
+	_setmode(_fileno(stdout), _O_BINARY);
+#endif
 
 	printf("Init of hardware finished.\n");
 }
@@ -47,6 +69,9 @@ void System_Init(void)
 /* Stub: Shutdown your hardware here */
 void System_Shutdown(void)
 {
+#if defined(UCUNIT_CAPTURE) && !defined(UCUNIT_CAPTURE_NO_DUMP)
+	UCUNIT_DumpCapture();
+#endif
 
 	/* asm("\tSTOP"); */
 	printf("System shutdown.\n");
@@ -65,6 +90,10 @@ void System_Recover(void)
 /* Stub: Put system in a safe state */
 void System_Safestate(void)
 {
+#if defined(UCUNIT_CAPTURE) && !defined(UCUNIT_CAPTURE_NO_DUMP)
+	UCUNIT_DumpCapture();
+#endif
+
 	/* Disable all port pins */
 	/* PORTA = 0x0000; */
 	/* PORTB = 0x0000; */
@@ -85,7 +114,562 @@ void System_WriteString(char * msg)
 	printf(msg);
 }
 
+/* Stub: Transmit a string from program memory. It is in RAM here. */
+void System_WriteString_P(const char * msg)
+{
+	System_WriteString((char *)msg);
+}
+
 void System_WriteInt(int n)
 {
-	printf("%i", n);
+	char buffer[UCUNIT_FORMAT_BUFFER_SIZE];
+
+	UCUNIT_FormatS32(buffer, n);
+	System_WriteString(buffer);
+}
+
+/* Stub: Transmit a raw byte to the host/debugger/simulator */
+void System_WriteByte(unsigned char b)
+{
+	putchar(b);
+}
+
+/* Stub: Transmit a buffer of characters to the host/debugger/simulator */
+void System_WriteBuffer(const char * buffer, int length)
+{
+	fwrite(buffer, 1, (size_t)length, stdout);
+}
+
+/* Copies the command line arguments, separated by blanks */
+void System_ReadCommand(int argc, char * argv[], char * buffer, int size)
+{
+	int length = 0;
+	int n;
+
+	for (n = 1; n < argc; n++)
+	{
+		char * arg = argv[n];
+
+		if ((n > 1) && (length < size - 1))
+		{
+			buffer[length++] = ' ';
+		}
+		while (*arg && (length < size - 1))
+		{
+			buffer[length++] = *arg++;
+		}
+	}
+	buffer[length] = 0;
+}
+
+#if defined(_WIN32)
+/* Performance counter of Windows */
+System_Ticks System_GetTicks(void)
+{
+	LARGE_INTEGER count;
+
+	QueryPerformanceCounter(&count);
+	return (System_Ticks)count.QuadPart;
+}
+
+unsigned long System_GetTicksPerSecond(void)
+{
+	LARGE_INTEGER frequency;
+
+	QueryPerformanceFrequency(&frequency);
+	return (unsigned long)frequency.QuadPart;
+}
+#elif defined(SYSTEM_USE_RDTSC)
+/* Time stamp counter of the CPU. Define SYSTEM_USE_RDTSC for cycle
+   accurate timing on CPUs with a constant rate TSC. */
+static unsigned long tsc_frequency = 0;
+
+static unsigned long long monotonic_ns(void)
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (unsigned long long)now.tv_sec * 1000000000ULL + now.tv_nsec;
+}
+
+System_Ticks System_GetTicks(void)
+{
+	unsigned int low;
+	unsigned int high;
+
+	__asm__ __volatile__("rdtsc" : "=a"(low), "=d"(high));
+	return (System_Ticks)(((unsigned long long)high << 32) | low);
+}
+
+unsigned long System_GetTicksPerSecond(void)
+{
+	if (0 == tsc_frequency)
+	{
+		/* Calibrate against CLOCK_MONOTONIC for 10 ms */
+		unsigned long long start_ns = monotonic_ns();
+		System_Ticks start = System_GetTicks();
+		unsigned long long elapsed_ns;
+
+		do
+		{
+			elapsed_ns = monotonic_ns() - start_ns;
+		} while (elapsed_ns < 10000000ULL);
+
+		tsc_frequency = (unsigned long)(
+			(unsigned long long)(System_GetTicks() - start) * 1000000000ULL
+			/ elapsed_ns);
+	}
+	return tsc_frequency;
+}
+#else
+/* Monotonic clock in nanoseconds */
+System_Ticks System_GetTicks(void)
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (System_Ticks)now.tv_sec * 1000000000UL + (System_Ticks)now.tv_nsec;
+}
+
+unsigned long System_GetTicksPerSecond(void)
+{
+	return 1000000000UL;
+}
+#endif
+
+#ifdef UCUNIT_PARALLEL
+#ifdef _WIN32
+#error "UCUNIT_PARALLEL needs a POSIX host"
+#endif
+
+/* Result of a test, written by the worker which ran it */
+typedef struct
+{
+	long begin; /* Offset of the output in the output file of the worker */
+	long end;
+	ucunit_statistics_t statistics;
+} system_result_t;
+
+/* Worker process, runs every jobs-th test */
+typedef struct
+{
+	pid_t pid;
+	FILE * output; /* stdout of the worker */
+	FILE * results; /* system_result_t of each finished test */
+	long copied; /* Offset of the output not yet copied */
+	int status; /* Exit status of the worker */
+	int lost; /* The worker did not finish all of its tests */
+} system_worker_t;
+
+/* Tests in the order of UCUNIT_ForEachTest() */
+typedef struct
+{
+	const ucunit_test_t ** test;
+	int count;
+} system_tests_t;
+
+static void collect_test(const ucunit_test_t * test, void * context)
+{
+	system_tests_t * tests = (system_tests_t *)context;
+
+	tests->test[tests->count++] = test;
+}
+
+/* Runs the tests first, first + jobs, ... with stdout redirected to the
+   output file. Each result is flushed at once, so the results of the
+   finished tests survive a crash of the worker. */
+static void run_worker(system_tests_t * tests, int first, int jobs,
+                       system_worker_t * worker)
+{
+	int n;
+
+	/* Line buffered, so the output of a crashing test is kept */
+	setvbuf(stdout, NULL, _IOLBF, BUFSIZ);
+	dup2(fileno(worker->output), STDOUT_FILENO);
+	for (n = first; n < tests->count; n += jobs)
+	{
+		system_result_t result;
+
+		result.begin = (long)lseek(STDOUT_FILENO, 0, SEEK_CUR);
+		UCUNIT_ResetStatistics();
+		UCUNIT_RunTest(tests->test[n]);
+		UCUNIT_GetStatistics(&result.statistics);
+		fflush(stdout);
+		result.end = (long)lseek(STDOUT_FILENO, 0, SEEK_CUR);
+		fwrite(&result, sizeof(result), 1, worker->results);
+		fflush(worker->results);
+	}
+	_exit(0);
+}
+
+/* Copies the output of a worker from worker->copied to end to stdout */
+static void copy_output(system_worker_t * worker, long end)
+{
+	char buffer[4096];
+
+	fseek(worker->output, worker->copied, SEEK_SET);
+	while ((end < 0) || (worker->copied < end))
+	{
+		size_t size = sizeof(buffer);
+		size_t length;
+
+		if ((end >= 0) && ((long)size > end - worker->copied))
+		{
+			size = (size_t)(end - worker->copied);
+		}
+		length = fread(buffer, 1, size, worker->output);
+		if (0 == length)
+		{
+			break;
+		}
+		fwrite(buffer, 1, length, stdout);
+		worker->copied += (long)length;
+	}
+}
+
+/* Writes why a worker did not finish a test and counts it as failed */
+static void report_lost_test(const ucunit_test_t * test, int status)
+{
+	ucunit_statistics_t failed = { 0, 0, 1, 0 };
+
+	printf("\n%s:%d: failed:Test(%s) worker ", test->file, test->line, test->name);
+	if (WIFSIGNALED(status))
+	{
+		printf("terminated by signal %d\n", WTERMSIG(status));
+	}
+	else
+	{
+		printf("exited with status %d\n", WEXITSTATUS(status));
+	}
+	UCUNIT_MergeStatistics(&failed);
+}
+
+/* Runs the tests in worker processes created with fork(). Each worker
+   writes its output into a temporary file, which is copied to stdout
+   in the order of the tests when all workers are done. */
+int System_RunParallel(const char * filter, int jobs)
+{
+	system_tests_t tests;
+	system_worker_t * workers;
+	int n;
+
+	tests.count = 0;
+	tests.test = malloc(sizeof(*tests.test) * (UCUNIT_CountTests() + 1));
+	if (0 == tests.test)
+	{
+		return 0;
+	}
+	UCUNIT_ForEachTest(filter, collect_test, &tests);
+
+	if (jobs <= 0)
+	{
+#ifdef _SC_NPROCESSORS_ONLN
+		jobs = (int)sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+	}
+	if (jobs > tests.count)
+	{
+		jobs = tests.count;
+	}
+	workers = (jobs > 1) ? calloc((size_t)jobs, sizeof(*workers)) : 0;
+	if (0 == workers)
+	{
+		for (n = 0; n < tests.count; n++)
+		{
+			UCUNIT_RunTest(tests.test[n]);
+		}
+		free(tests.test);
+		return n;
+	}
+
+	/* Nothing buffered may be written twice by the workers */
+	fflush(stdout);
+	for (n = 0; n < jobs; n++)
+	{
+		workers[n].output = tmpfile();
+		workers[n].results = tmpfile();
+		workers[n].pid = -1;
+		if ((0 != workers[n].output) && (0 != workers[n].results))
+		{
+			workers[n].pid = fork();
+		}
+		if (0 == workers[n].pid)
+		{
+			run_worker(&tests, n, jobs, &workers[n]);
+		}
+		if (workers[n].pid < 0)
+		{
+			perror("System_RunParallel");
+			exit(1);
+		}
+	}
+
+	for (n = 0; n < tests.count; n++)
+	{
+		system_worker_t * worker = &workers[n % jobs];
+		system_result_t result;
+
+		if (n < jobs)
+		{
+			waitpid(worker->pid, &worker->status, 0);
+			rewind(worker->results);
+		}
+		if (!worker->lost &&
+		    (1 == fread(&result, sizeof(result), 1, worker->results)))
+		{
+			copy_output(worker, result.end);
+			UCUNIT_MergeStatistics(&result.statistics);
+			continue;
+		}
+
+		/* The worker died in this test, its output is written as far
+		   as it came. The rest of its tests are counted as failed. */
+		if (!worker->lost)
+		{
+			copy_output(worker, -1);
+			fflush(stdout);
+			worker->lost = 1;
+		}
+		report_lost_test(tests.test[n], worker->status);
+	}
+	fflush(stdout);
+
+	for (n = 0; n < jobs; n++)
+	{
+		fclose(workers[n].output);
+		fclose(workers[n].results);
+	}
+	free(workers);
+	free(tests.test);
+	return tests.count;
+}
+#endif
+
+#ifdef UCUNIT_CRASH_RECOVERY
+#ifdef _WIN32
+#error "UCUNIT_CRASH_RECOVERY needs a POSIX host"
+#endif
+
+/* Signals of a crashing test */
+static const int crash_signals[] = { SIGSEGV, SIGBUS, SIGFPE, SIGILL, SIGABRT };
+#define CRASH_SIGNALS (int)(sizeof(crash_signals) / sizeof(crash_signals[0]))
+
+/* Own stack for the handler, a stack overflow is a crash, too */
+static char crash_stack[65536];
+static sigjmp_buf crash_jump;
+static volatile sig_atomic_t crash_signal = 0;
+
+/* TRUE while System_RunProtected() runs a test */
+static volatile sig_atomic_t crash_active = 0;
+
+static void crash_handler(int signal)
+{
+	crash_signal = signal;
+	siglongjmp(crash_jump, 1);
+}
+
+/* Runs a test function. If it raises one of the crash signals, the
+   handler jumps back here and restores the signal mask. */
+int System_RunProtected(void (*function)(void))
+{
+	struct sigaction action;
+	struct sigaction previous[CRASH_SIGNALS];
+	stack_t stack;
+	int n;
+
+	stack.ss_sp = crash_stack;
+	stack.ss_size = sizeof(crash_stack);
+	stack.ss_flags = 0;
+	sigaltstack(&stack, NULL);
+
+	action.sa_handler = crash_handler;
+	action.sa_flags = SA_ONSTACK;
+	sigemptyset(&action.sa_mask);
+	for (n = 0; n < CRASH_SIGNALS; n++)
+	{
+		sigaction(crash_signals[n], &action, &previous[n]);
+	}
+
+	crash_signal = 0;
+	if (0 == sigsetjmp(crash_jump, 1))
+	{
+		crash_active = 1;
+		function();
+	}
+	crash_active = 0;
+
+	for (n = 0; n < CRASH_SIGNALS; n++)
+	{
+		sigaction(crash_signals[n], &previous[n], NULL);
+	}
+	return crash_signal;
+}
+#endif
+
+#ifdef UCUNIT_TIMEOUTS
+#ifdef _WIN32
+#error "UCUNIT_TIMEOUTS needs a POSIX host"
+#endif
+
+/* One-shot timer of the running testcase, created by the process which
+   uses it. Workers of System_RunParallel() do not inherit it. */
+static timer_t timeout_timer;
+static pid_t timeout_owner = 0;
+
+static void timeout_handler(int signal)
+{
+	static const char message[] = "\nTestcase timeout expired.\n";
+
+	(void)signal;
+#ifdef UCUNIT_CRASH_RECOVERY
+	if (crash_active)
+	{
+		crash_signal = UCUNIT_SIGNAL_TIMEOUT;
+		siglongjmp(crash_jump, 1);
+	}
+#endif
+	/* Without crash recovery the run cannot continue. Only async-signal
+	   safe calls are allowed here, so stdout is flushed when the timer is
+	   armed rather than in the handler. Output buffered by the testcase
+	   itself after that point is lost. */
+	if (write(STDOUT_FILENO, message, sizeof(message) - 1) < 0)
+	{
+		/* Nothing left to report the error to */
+	}
+	_exit(1);
+}
+
+void System_StartTimeout(unsigned long ms)
+{
+	struct itimerspec time;
+
+	if (getpid() != timeout_owner)
+	{
+		struct sigaction action;
+		struct sigevent event;
+
+		action.sa_handler = timeout_handler;
+		action.sa_flags = SA_ONSTACK;
+		sigemptyset(&action.sa_mask);
+		sigaction(SIGALRM, &action, NULL);
+
+		event.sigev_notify = SIGEV_SIGNAL;
+		event.sigev_signo = SIGALRM;
+		event.sigev_value.sival_ptr = NULL;
+		if (0 != timer_create(CLOCK_MONOTONIC, &event, &timeout_timer))
+		{
+			perror("timer_create");
+			return;
+		}
+		timeout_owner = getpid();
+	}
+
+	/* The handler cannot flush stdout, see timeout_handler() */
+	fflush(stdout);
+
+	time.it_interval.tv_sec = 0;
+	time.it_interval.tv_nsec = 0;
+	time.it_value.tv_sec = (time_t)(ms / 1000UL);
+	time.it_value.tv_nsec = (long)(ms % 1000UL) * 1000000L;
+	timer_settime(timeout_timer, 0, &time, NULL);
+}
+
+void System_StopTimeout(void)
+{
+	struct itimerspec time;
+
+	if (getpid() == timeout_owner)
+	{
+		time.it_interval.tv_sec = 0;
+		time.it_interval.tv_nsec = 0;
+		time.it_value.tv_sec = 0;
+		time.it_value.tv_nsec = 0;
+		timer_settime(timeout_timer, 0, &time, NULL);
+	}
+}
+#endif
+
+#ifdef UCUNIT_SINKS
+static void fd_sink_write(ucunit_sink_t * sink, const char * buffer, int length)
+{
+	ucunit_fd_sink_t * fd_sink = (ucunit_fd_sink_t *)sink;
+
+	while (length > 0)
+	{
+		int written = (int)write(fd_sink->fd, buffer, (size_t)length);
+
+		if (written <= 0)
+		{
+			break;
+		}
+		buffer += written;
+		length -= written;
+	}
+}
+
+static void fd_sink_flush(ucunit_sink_t * sink)
+{
+	(void)sink; /* write() is not buffered */
+}
+
+static void fd_sink_close(ucunit_sink_t * sink)
+{
+	close(((ucunit_fd_sink_t *)sink)->fd);
+}
+
+/* Sink which writes to a file descriptor, e.g. a file or a pipe */
+void System_FdSinkInit(ucunit_fd_sink_t * sink, int fd)
+{
+	sink->sink.write = fd_sink_write;
+	sink->sink.flush = fd_sink_flush;
+	sink->sink.close = fd_sink_close;
+	sink->fd = fd;
+}
+#endif
+
+#ifdef UCUNIT_REPORTERS
+/* Opens the file of --report=tap:path or --report=junit:path */
+ucunit_sink_t * System_OpenReport(const char * path)
+{
+	static ucunit_fd_sink_t report;
+	int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+
+	if (fd < 0)
+	{
+		return NULL;
+	}
+	System_FdSinkInit(&report, fd);
+	return &report.sink;
+}
+#endif
+
+#ifdef UCUNIT_PERSIST_SYSTEM
+/* File for the progress record of UCUNIT_PERSIST */
+#ifndef SYSTEM_PERSIST_FILE
+#define SYSTEM_PERSIST_FILE "ucunit.state"
+#endif
+
+int System_LoadPersistent(void * buffer, int size)
+{
+	FILE * file = fopen(SYSTEM_PERSIST_FILE, "rb");
+	int loaded = 0;
+
+	if (NULL != file)
+	{
+		loaded = (1 == fread(buffer, (size_t)size, 1, file));
+		fclose(file);
+	}
+	return loaded;
+}
+
+void System_SavePersistent(const void * buffer, int size)
+{
+	FILE * file = fopen(SYSTEM_PERSIST_FILE, "wb");
+
+	if (NULL != file)
+	{
+		fwrite(buffer, (size_t)size, 1, file);
+		fclose(file);
+	}
 }
+#endif
@@ -37,7 +37,9 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <time.h>
 #include "../System.h"
+#include "../uCUnit-v1.0.h"
 
 /* Stub: Initialize your hardware here */
 void System_Init(void)
@@ -49,6 +51,9 @@ void System_Init(void)
 /* Stub: Shutdown your hardware here */
 void System_Shutdown(void)
 {
+#if defined(UCUNIT_CAPTURE) && !defined(UCUNIT_CAPTURE_NO_DUMP)
+	UCUNIT_DumpCapture();
+#endif
 
 	/* asm("\tSTOP"); */
 	printf("System shutdown.\n");
@@ -67,6 +72,10 @@ void System_Recover(void)
 /* Stub: Put system in a safe state */
 void System_Safestate(void)
 {
+#if defined(UCUNIT_CAPTURE) && !defined(UCUNIT_CAPTURE_NO_DUMP)
+	UCUNIT_DumpCapture();
+#endif
+
 	/* Disable all port pins */
 	/* PORTA = 0x0000; */
 	/* PORTB = 0x0000; */
@@ -87,7 +96,90 @@ void System_WriteString(char * msg)
 	printf(msg);
 }
 
+/* Stub: Transmit a string from program memory. It is in RAM here. */
+void System_WriteString_P(const char * msg)
+{
+	System_WriteString((char *)msg);
+}
+
 void System_WriteInt(int n)
 {
-	printf("%i", n);
+	char buffer[UCUNIT_FORMAT_BUFFER_SIZE];
+
+	UCUNIT_FormatS32(buffer, n);
+	System_WriteString(buffer);
+}
+
+/* Stub: Transmit a raw byte to the host/debugger/simulator */
+void System_WriteByte(unsigned char b)
+{
+	putchar(b);
+}
+
+/* Stub: Transmit a buffer of characters to the host/debugger/simulator */
+void System_WriteBuffer(const char * buffer, int length)
+{
+	fwrite(buffer, 1, (size_t)length, stdout);
+}
+
+/* Stub: Read a command line from the host, e.g. from the UART */
+void System_ReadCommand(int argc, char * argv[], char * buffer, int size)
+{
+	(void)argc;
+	(void)argv;
+	(void)size;
+	buffer[0] = 0;
+}
+
+/* Stub: Read a free running cycle counter or hardware timer */
+System_Ticks System_GetTicks(void)
+{
+	return (System_Ticks)clock();
+}
+
+/* Stub: Frequency of the counter of System_GetTicks() */
+unsigned long System_GetTicksPerSecond(void)
+{
+	return (unsigned long)CLOCKS_PER_SEC;
+}
+
+#ifdef UCUNIT_PERSIST_SYSTEM
+/* Stub: Read the progress record from EEPROM or flash */
+int System_LoadPersistent(void * buffer, int size)
+{
+	(void)buffer;
+	(void)size;
+	return 0;
+}
+
+/* Stub: Write the progress record to EEPROM or flash */
+void System_SavePersistent(const void * buffer, int size)
+{
+	(void)buffer;
+	(void)size;
+}
+#endif
+
+#ifdef UCUNIT_TIMEOUTS
+/* Stub: Start the watchdog or a timer which resets the system after ms
+   milliseconds. UCUNIT_PERSIST reports the testcase after the reset. */
+void System_StartTimeout(unsigned long ms)
+{
+	(void)ms;
+}
+
+/* Stub: Stop the watchdog or timer of System_StartTimeout() */
+void System_StopTimeout(void)
+{
+}
+#endif
+
+#ifdef UCUNIT_REPORTERS
+/* Stub: Open a file for the report of --report=tap:path, NULL if the
+   target has no files. The report goes to the output then. */
+ucunit_sink_t * System_OpenReport(const char * path)
+{
+	(void)path;
+	return NULL;
 }
+#endif
@@ -0,0 +1,102 @@
+#!/usr/bin/env python3
+#############################################################################
+#                                                                           #
+#  uCUnit - A unit testing framework for microcontrollers                   #
+#                                                                           #
+#  (C) 2007 - 2008 Sven Stefan Krauss                                       #
+#                  https://www.ucunit.org                                   #
+#                                                                           #
+#  File        : ucunit_capture.py                                          #
+#  Description : Extracts the output of UCUNIT_CAPTURE from an image.       #
+#  Author      : Sven Stefan Krauss                                         #
+#  Contact     : www.ucunit.org                                             #
+#                                                                           #
+#############################################################################
+#
+# This file is part of ucUnit.
+#
+# You can redistribute and/or modify it under the terms of the
+# Common Public License as published by IBM Corporation; either
+# version 1.0 of the License, or (at your option) any later version.
+#
+# uCUnit is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# Common Public License for more details.
+#
+# You should have received a copy of the Common Public License
+# along with uCUnit.
+#
+# It may also be available at the following URL:
+#       http://www.opensource.org/licenses/cpl1.0.txt
+#
+# If you cannot obtain a copy of the License, please contact the
+# author.
+#
+"""Extract the RAM capture buffer of UCUNIT_CAPTURE from a memory image.
+
+Usage: ucunit_capture.py IMAGE [TABLE]
+
+IMAGE is a dump of the target RAM or a core file, e.g. written by the
+simulator or with the gdb command
+    dump binary value ram.bin ucunit_capture
+The buffer is found by its magic. The captured output is written to
+stdout. If TABLE is given, the output is tokenized and decoded with the
+site table of ucunit_sites.py.
+"""
+
+import os
+import struct
+import sys
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+
+import ucunit_decode  # noqa: E402
+
+MAGIC = b'uCUCAPT\0'
+HEADER_SIZE = len(MAGIC) + 12
+
+
+def find_capture(image):
+    """Returns (data, dropped) of the capture buffer with the most output."""
+    best = None
+    start = image.find(MAGIC)
+    while start >= 0:
+        header = image[start + len(MAGIC):start + HEADER_SIZE]
+        for order in '<>':
+            if len(header) < 12:
+                break
+            size, length, dropped = struct.unpack(order + '3I', header)
+            end = start + HEADER_SIZE + length
+            if length <= size and start + HEADER_SIZE + size <= len(image):
+                if best is None or length > len(best[0]):
+                    best = (image[start + HEADER_SIZE:end], dropped)
+                break
+        start = image.find(MAGIC, start + 1)
+    return best
+
+
+def main(argv):
+    if len(argv) not in (2, 3):
+        sys.stderr.write(__doc__)
+        return 2
+    with open(argv[1], 'rb') as f:
+        image = f.read()
+    capture = find_capture(image)
+    if capture is None:
+        sys.stderr.write('%s: no capture buffer found\n' % argv[1])
+        return 1
+    data, dropped = capture
+    if len(argv) == 3:
+        sites = ucunit_decode.load_table(argv[2])
+        ucunit_decode.Decoder(sites, sys.stdout).decode(data)
+    else:
+        sys.stdout.write(data.decode('latin-1'))
+    if dropped:
+        sys.stderr.write('%s: capture buffer full, dropped: %d\n'
+                         % (argv[1], dropped))
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv))
@@ -0,0 +1,241 @@
+#!/usr/bin/env python3
+#############################################################################
+#                                                                           #
+#  uCUnit - A unit testing framework for microcontrollers                   #
+#                                                                           #
+#  (C) 2007 - 2008 Sven Stefan Krauss                                       #
+#                  https://www.ucunit.org                                   #
+#                                                                           #
+#  File        : ucunit_decode.py                                           #
+#  Description : Decodes the output of UCUNIT_MODE_TOKENIZED.               #
+#  Author      : Sven Stefan Krauss                                         #
+#  Contact     : www.ucunit.org                                             #
+#                                                                           #
+#############################################################################
+#
+# This file is part of ucUnit.
+#
+# You can redistribute and/or modify it under the terms of the
+# Common Public License as published by IBM Corporation; either
+# version 1.0 of the License, or (at your option) any later version.
+#
+# uCUnit is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# Common Public License for more details.
+#
+# You should have received a copy of the Common Public License
+# along with uCUnit.
+#
+# It may also be available at the following URL:
+#       http://www.opensource.org/licenses/cpl1.0.txt
+#
+# If you cannot obtain a copy of the License, please contact the
+# author.
+#
+"""Convert tokenized uCUnit output back into the text output.
+
+Usage: ucunit_decode.py TABLE [LOG]
+
+TABLE is written by ucunit_sites.py. LOG is the captured output of the
+target, stdin is read if it is omitted. Text between the records is
+copied unchanged.
+"""
+
+import struct
+import sys
+
+TOKEN_PASSED = 0x80
+TOKEN_FAILED = 0x81
+TOKEN_TESTCASE_BEGIN = 0x82
+TOKEN_TESTCASE_PASSED = 0x83
+TOKEN_TESTCASE_FAILED = 0x84
+TOKEN_SUMMARY = 0x85
+TOKEN_VALUE = 0x86
+TOKEN_TYPED_VALUE = 0x87
+
+
+def format_double(value):
+    """Same as UCUNIT_FormatDouble(), step by step."""
+    if value != value:
+        return 'nan'
+    sign = ''
+    if value < 0:
+        sign = '-'
+        value = -value
+    if value - value != 0:
+        return sign + 'inf'
+    digits = 0
+    exponent = 0
+    if value > 0:
+        while value >= 10.0:
+            value /= 10.0
+            exponent += 1
+        while value < 1.0:
+            value *= 10.0
+            exponent -= 1
+        digits = int(value * 1000000.0 + 0.5)
+        if digits >= 10000000:
+            digits //= 10
+            exponent += 1
+    return '%s%d.%06de%s%02d' % (sign, digits // 1000000, digits % 1000000,
+                                 '-' if exponent < 0 else '+', abs(exponent))
+
+
+# Type byte of TOKEN_TYPED_VALUE: payload format and text format
+VALUE_TYPES = {
+    0: ('<i', '%d'),
+    1: ('<I', '%u'),
+    2: ('<q', '%d'),
+    3: ('<Q', '%u'),
+    4: ('<I', '0x%08X'),
+    5: ('<Q', '0x%016X'),
+    6: ('<I', '0x%08X'),
+    7: ('<f', format_double),
+    8: ('<d', format_double),
+}
+
+SEPARATOR = '======================================\n'
+STARS = '**************************************'
+
+
+def unescape(s):
+    out = []
+    i = 0
+    while i < len(s):
+        if s[i] == '\\' and i + 1 < len(s):
+            out.append({'t': '\t', 'n': '\n'}.get(s[i + 1], s[i + 1]))
+            i += 2
+        else:
+            out.append(s[i])
+            i += 1
+    return ''.join(out)
+
+
+def load_table(path):
+    sites = {}
+    with open(path, encoding='latin-1') as f:
+        for line in f:
+            if line.startswith('#') or not line.strip():
+                continue
+            fields = [unescape(x) for x in line.rstrip('\n').split('\t')]
+            file_id, lineno, name, kind, msg, args = fields
+            sites[(int(file_id), int(lineno))] = (name, kind, msg, args)
+    return sites
+
+
+class Decoder:
+
+    def __init__(self, sites, out):
+        self.sites = sites
+        self.out = out
+        self.pending = None
+        self.values = []
+
+    def site(self, file_id, line):
+        return self.sites.get((file_id, line),
+                              ('<file %d>' % file_id, 'check', '?', ''))
+
+    def flush(self):
+        if self.pending is not None:
+            line = self.pending
+            if self.values:
+                line += ' [' + ', '.join(self.values) + ']'
+            self.out.write(line + '\n')
+        self.pending = None
+        self.values = []
+
+    def check(self, file_id, line, result, msg=None):
+        name, kind, site_msg, args = self.site(file_id, line)
+        if msg is None:
+            msg = site_msg
+        else:
+            args = ''
+        self.pending = '%s:%d: %s:%s(%s)' % (name, line, result, msg, args)
+
+    def record(self, tag, data):
+        if tag == TOKEN_VALUE:
+            self.values.append(str(struct.unpack('<i', data)[0]))
+            return
+        if tag == TOKEN_TYPED_VALUE:
+            fmt, text = VALUE_TYPES[data[0]]
+            value = struct.unpack(fmt, data[1:])[0]
+            if callable(text):
+                self.values.append(text(value))
+            else:
+                self.values.append(text % value)
+            return
+        self.flush()
+        if tag == TOKEN_SUMMARY:
+            tf, tp, cf, cp = struct.unpack('<4I', data)
+            self.out.write('\n%s\nTestcases: failed: %d\n           passed: %d'
+                           '\nChecks:    failed: %d\n           passed: %d'
+                           '\n%s\n' % (STARS, tf, tp, cf, cp, STARS))
+            return
+        file_id, line = struct.unpack('<BH', data)
+        if tag == TOKEN_PASSED:
+            self.check(file_id, line, 'passed')
+        elif tag == TOKEN_FAILED:
+            self.check(file_id, line, 'failed')
+        elif tag == TOKEN_TESTCASE_BEGIN:
+            self.out.write('\n' + SEPARATOR + self.site(file_id, line)[2] +
+                           '\n' + SEPARATOR)
+        elif tag == TOKEN_TESTCASE_PASSED:
+            self.out.write(SEPARATOR + 'Testcase passed.\n' + SEPARATOR)
+        elif tag == TOKEN_TESTCASE_FAILED:
+            self.out.write(SEPARATOR)
+            self.check(file_id, line, 'failed', 'EndTestcase')
+            self.flush()
+            self.out.write(SEPARATOR)
+
+    def text(self, data):
+        self.flush()
+        self.out.write(data.decode('latin-1'))
+
+    def decode(self, data):
+        sizes = {TOKEN_SUMMARY: 16, TOKEN_VALUE: 4}
+        i = 0
+        while i < len(data):
+            tag = data[i]
+            if tag < 0x80:
+                j = i
+                while j < len(data) and data[j] < 0x80:
+                    j += 1
+                self.text(data[i:j])
+                i = j
+                continue
+            if tag > TOKEN_TYPED_VALUE:
+                sys.stderr.write('offset %d: unknown tag 0x%02x\n' % (i, tag))
+                i += 1
+                continue
+            size = sizes.get(tag, 3)
+            if tag == TOKEN_TYPED_VALUE:
+                if i + 1 >= len(data) or data[i + 1] not in VALUE_TYPES:
+                    sys.stderr.write('offset %d: bad value record\n' % i)
+                    i += 1
+                    continue
+                size = 1 + struct.calcsize(VALUE_TYPES[data[i + 1]][0])
+            if i + 1 + size > len(data):
+                sys.stderr.write('offset %d: truncated record\n' % i)
+                break
+            self.record(tag, data[i + 1:i + 1 + size])
+            i += 1 + size
+        self.flush()
+
+
+def main(argv):
+    if len(argv) not in (2, 3):
+        sys.stderr.write(__doc__)
+        return 2
+    sites = load_table(argv[1])
+    if len(argv) == 3:
+        with open(argv[2], 'rb') as f:
+            data = f.read()
+    else:
+        data = sys.stdin.buffer.read()
+    Decoder(sites, sys.stdout).decode(data)
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv))
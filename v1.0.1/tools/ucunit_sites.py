@@ -0,0 +1,226 @@
+#!/usr/bin/env python3
+#############################################################################
+#                                                                           #
+#  uCUnit - A unit testing framework for microcontrollers                   #
+#                                                                           #
+#  (C) 2007 - 2008 Sven Stefan Krauss                                       #
+#                  https://www.ucunit.org                                   #
+#                                                                           #
+#  File        : ucunit_sites.py                                            #
+#  Description : Builds the site table for UCUNIT_MODE_TOKENIZED.           #
+#  Author      : Sven Stefan Krauss                                         #
+#  Contact     : www.ucunit.org                                             #
+#                                                                           #
+#############################################################################
+#
+# This file is part of ucUnit.
+#
+# You can redistribute and/or modify it under the terms of the
+# Common Public License as published by IBM Corporation; either
+# version 1.0 of the License, or (at your option) any later version.
+#
+# uCUnit is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# Common Public License for more details.
+#
+# You should have received a copy of the Common Public License
+# along with uCUnit.
+#
+# It may also be available at the following URL:
+#       http://www.opensource.org/licenses/cpl1.0.txt
+#
+# If you cannot obtain a copy of the License, please contact the
+# author.
+#
+"""Scan testsuite sources and write the uCUnit site table.
+
+Usage: ucunit_sites.py [-o TABLE] SOURCE...
+
+Pass the sources with the same paths as on the compiler command line, the
+path is what __FILE__ expands to. Each source may define its own
+UCUNIT_FILE_ID, the default is 0.
+
+The table has one tab separated line per source line of a check site:
+    file_id  line  file  kind  msg  args
+"""
+
+import os
+import re
+import sys
+
+MACRO_RE = re.compile(r'\bUCUNIT_(\w+)\s*\(')
+FILE_ID_RE = re.compile(r'^\s*#\s*define\s+UCUNIT_FILE_ID\s+(\w+)', re.M)
+STRING_RE = re.compile(r'"((?:[^"\\\n]|\\.)*)"')
+
+
+def strip_comments(text):
+    """Replace comments by blanks, keep newlines and string literals."""
+    out = []
+    i = 0
+    n = len(text)
+    while i < n:
+        c = text[i]
+        if c in '"\'':
+            j = i + 1
+            while j < n and text[j] != c:
+                j += 2 if text[j] == '\\' else 1
+            out.append(text[i:j + 1])
+            i = j + 1
+        elif text.startswith('/*', i):
+            j = text.find('*/', i + 2)
+            j = n if j < 0 else j + 2
+            out.append(re.sub(r'[^\n]', ' ', text[i:j]))
+            i = j
+        elif text.startswith('//', i):
+            j = text.find('\n', i)
+            j = n if j < 0 else j
+            out.append(' ' * (j - i))
+            i = j
+        else:
+            out.append(c)
+            i += 1
+    return ''.join(out)
+
+
+def split_args(text, start):
+    """Split the macro arguments starting after the opening parenthesis.
+
+    Returns the list of arguments and the index of the closing parenthesis.
+    """
+    args = []
+    depth = 0
+    cur = []
+    i = start
+    while i < len(text):
+        c = text[i]
+        if c in '"\'':
+            j = i + 1
+            while j < len(text) and text[j] != c:
+                j += 2 if text[j] == '\\' else 1
+            cur.append(text[i:j + 1])
+            i = j + 1
+            continue
+        if c in '([{':
+            depth += 1
+        elif c in ')]}':
+            if depth == 0:
+                args.append(''.join(cur))
+                return args, i
+            depth -= 1
+        elif c == ',' and depth == 0:
+            args.append(''.join(cur))
+            cur = []
+            i += 1
+            continue
+        cur.append(c)
+        i += 1
+    raise ValueError('unterminated macro call')
+
+
+def stringize(arg):
+    """Same as the # operator of the preprocessor."""
+    return ' '.join(arg.split())
+
+
+def literal(arg):
+    """Value of a (concatenated) string literal, else the stringized arg."""
+    parts = STRING_RE.findall(arg)
+    if not parts or STRING_RE.sub('', arg).strip():
+        return stringize(arg)
+    raw = ''.join(parts)
+    return raw.encode('latin-1').decode('unicode_escape')
+
+
+def site(name, args):
+    """Returns (kind, msg, args) of a macro call or None."""
+    if name == 'TestcaseBegin':
+        return 'testcase', literal(args[0]), ''
+    if name in ('TestcaseBeginDeadline', 'TestcaseBeginTimeout',
+                'TestcaseBeginLimits'):
+        return 'testcase', literal(args[0]), ''
+    if name == 'TestcaseEnd':
+        # Check records at the end of a testcase are deadline checks
+        return 'testcase_end', 'TestcaseDeadline', ''
+    if name == 'ChecklistEnd':
+        return 'check', 'Checklist', ''
+    if name == 'Tracepoint':
+        return 'check', 'Tracepoint index', stringize(args[0])
+    if name == 'DigestCheck':
+        return 'check', name, ','.join(stringize(a) for a in args)
+    if name == 'Check':
+        return 'check', literal(args[1]), literal(args[2])
+    if name.startswith('Check'):
+        return 'check', name[len('Check'):], \
+            ','.join(stringize(a) for a in args)
+    return None
+
+
+def escape(s):
+    return s.replace('\\', '\\\\').replace('\t', '\\t').replace('\n', '\\n')
+
+
+def scan(path):
+    with open(path, encoding='latin-1') as f:
+        text = strip_comments(f.read())
+    m = FILE_ID_RE.search(text)
+    file_id = int(m.group(1), 0) if m else 0
+    for m in MACRO_RE.finditer(text):
+        line = text.count('\n', 0, m.start()) + 1
+        if text[text.rfind('\n', 0, m.start()) + 1:m.start()].lstrip() \
+                .startswith('#'):
+            continue
+        args, end = split_args(text, m.end())
+        if text[end + 1:].lstrip().startswith('{'):
+            # Function definition, e.g. UCUNIT_CheckSite() of the library
+            continue
+        entry = site(m.group(1), args)
+        if entry is None:
+            continue
+        last = text.count('\n', 0, end) + 1
+        # __LINE__ of a macro call spanning several lines depends on the
+        # compiler, so every line of the call is listed.
+        for l in range(line, last + 1):
+            yield (file_id, l, path) + entry
+
+
+def write_table(out, paths):
+    ids = {}
+    out.write('# file_id\tline\tfile\tkind\tmsg\targs\n')
+    for path in paths:
+        for entry in scan(path):
+            other = ids.setdefault(entry[0], path)
+            if other != path:
+                sys.stderr.write('%s: UCUNIT_FILE_ID %d already used by %s\n'
+                                 % (path, entry[0], other))
+                return 1
+            out.write('\t'.join(escape(str(x)) for x in entry) + '\n')
+    return 0
+
+
+def main(argv):
+    table = None
+    if len(argv) > 2 and argv[1] == '-o':
+        table = argv[2]
+        argv = argv[2:]
+    if len(argv) < 2:
+        sys.stderr.write(__doc__)
+        return 2
+    if table is None:
+        return write_table(sys.stdout, argv[1:])
+    # Write to a temporary file, so make does not take a partial table
+    # for an up to date one when the scan fails.
+    temp = table + '.tmp'
+    try:
+        with open(temp, 'w') as out:
+            status = write_table(out, argv[1:])
+        if status == 0:
+            os.replace(temp, table)
+    finally:
+        if os.path.exists(temp):
+            os.remove(temp)
+    return status
+
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv))
@@ -0,0 +1,2972 @@
+/*****************************************************************************
+ *                                                                           *
+ *  uCUnit - A unit testing framework for microcontrollers                   *
+ *                                                                           *
+ *  (C) 2007 - 2008 Sven Stefan Krauss                                       *
+ *                  https://www.ucunit.org                                   *
+ *                                                                           *
+ *  File        : uCUnit-v1.0.c                                              *
+ *  Description : Functions used by the uCUnit macros                        *
+ *  Author      : Sven Stefan Krauss                                         *
+ *  Contact     : www.ucunit.org                                             *
+ *                                                                           *
+ *****************************************************************************/
+
+/*
+ * This file is part of ucUnit.
+ *
+ * You can redistribute and/or modify it under the terms of the
+ * Common Public License as published by IBM Corporation; either
+ * version 1.0 of the License, or (at your option) any later version.
+ *
+ * uCUnit is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * Common Public License for more details.
+ *
+ * You should have received a copy of the Common Public License
+ * along with uCUnit.
+ *
+ * It may also be available at the following URL:
+ *       http://www.opensource.org/licenses/cpl1.0.txt
+ *
+ * If you cannot obtain a copy of the License, please contact the
+ * author.
+ */
+
+#include "System.h"
+#include "uCUnit-v1.0.h"
+
+#if defined(__SSE2__) && !defined(UCUNIT_NO_SIMD)
+#include <emmintrin.h>
+#define UCUNIT_USE_SSE2
+#endif
+
+/*****************************************************************************/
+/* Variables                                                                 */
+/*****************************************************************************/
+
+/* State of uCUnit shared by all files of the testsuite */
+ucunit_state_t ucunit_state;
+
+/*****************************************************************************/
+/* Statistics                                                                */
+/*****************************************************************************/
+
+void UCUNIT_GetStatistics(ucunit_statistics_t * statistics)
+{
+    *statistics = ucunit_state.statistics;
+}
+
+void UCUNIT_MergeStatistics(const ucunit_statistics_t * statistics)
+{
+    ucunit_state.statistics.checks_failed += statistics->checks_failed;
+    ucunit_state.statistics.checks_passed += statistics->checks_passed;
+    ucunit_state.statistics.testcases_failed += statistics->testcases_failed;
+    ucunit_state.statistics.testcases_passed += statistics->testcases_passed;
+}
+
+void UCUNIT_WriteCounter(ucunit_counter_t n)
+{
+    char buffer[UCUNIT_FORMAT_BUFFER_SIZE];
+
+#if UCUNIT_COUNTER_BITS == 64
+    UCUNIT_FormatU64(buffer, n);
+#else
+    UCUNIT_FormatU32(buffer, (ucunit_uint32_t)n);
+#endif
+    UCUNIT_WriteString(buffer);
+}
+
+void UCUNIT_ResetStatistics(void)
+{
+    ucunit_state.statistics.checks_failed = 0;
+    ucunit_state.statistics.checks_passed = 0;
+    ucunit_state.statistics.testcases_failed = 0;
+    ucunit_state.statistics.testcases_passed = 0;
+}
+
+#ifdef UCUNIT_SINKS
+/*****************************************************************************/
+/* Output sinks                                                              */
+/*****************************************************************************/
+
+static void ucunit_system_write(ucunit_sink_t * sink, const char * buffer, int length)
+{
+    (void)sink;
+    UCUNIT_WriteBuffer(buffer, length);
+}
+
+static void ucunit_sink_nothing(ucunit_sink_t * sink)
+{
+    (void)sink;
+}
+
+ucunit_sink_t ucunit_system_sink = { ucunit_system_write, ucunit_sink_nothing, ucunit_sink_nothing };
+
+#ifdef UCUNIT_CAPTURE
+/* Cleared at startup, the header is written with the first output */
+ucunit_capture_t ucunit_capture;
+
+static void ucunit_capture_write(ucunit_sink_t * sink, const char * buffer, int length)
+{
+    (void)sink;
+    if (0 == ucunit_capture.size)
+    {
+        const char * magic = UCUNIT_CAPTURE_MAGIC;
+        int n;
+
+        for (n = 0; n < (int)sizeof(ucunit_capture.magic); n++)
+        {
+            ucunit_capture.magic[n] = magic[n];
+        }
+        ucunit_capture.size = UCUNIT_CAPTURE_SIZE;
+    }
+    while (length-- > 0)
+    {
+        if (ucunit_capture.length < UCUNIT_CAPTURE_SIZE)
+        {
+            ucunit_capture.data[ucunit_capture.length++] = *buffer++;
+        }
+        else
+        {
+            ucunit_capture.dropped += (ucunit_uint32_t)length + 1;
+            break;
+        }
+    }
+}
+
+ucunit_sink_t ucunit_capture_sink = { ucunit_capture_write, ucunit_sink_nothing, ucunit_sink_nothing };
+
+void UCUNIT_DumpCapture(void)
+{
+    char buffer[UCUNIT_FORMAT_BUFFER_SIZE];
+    int length;
+
+    UCUNIT_FlushSink();
+    UCUNIT_WriteBuffer(ucunit_capture.data, (int)ucunit_capture.length);
+    if (ucunit_capture.dropped > 0)
+    {
+        UCUNIT_WriteBuffer("\nCapture: dropped: ", 19);
+        length = UCUNIT_FormatU32(buffer, (unsigned long)ucunit_capture.dropped);
+        buffer[length++] = '\n';
+        UCUNIT_WriteBuffer(buffer, length);
+    }
+}
+
+#define UCUNIT_DEFAULT_SINK (&ucunit_capture_sink)
+#else
+#define UCUNIT_DEFAULT_SINK (&ucunit_system_sink)
+#endif
+
+static ucunit_sink_t * ucunit_current_sink(void)
+{
+    return (NULL == ucunit_state.sink) ? UCUNIT_DEFAULT_SINK : ucunit_state.sink;
+}
+
+/* Writes the output buffer to the current sink */
+static void ucunit_sink_drain(void)
+{
+    if (ucunit_state.sink_length > 0)
+    {
+        ucunit_sink_t * sink = ucunit_current_sink();
+
+        sink->write(sink, ucunit_state.sink_buffer, ucunit_state.sink_length);
+        ucunit_state.sink_length = 0;
+    }
+}
+
+static void ucunit_sink_put(char c)
+{
+    ucunit_state.sink_buffer[ucunit_state.sink_length++] = c;
+    if (('\n' == c) || (UCUNIT_SINK_BUFFER_SIZE == ucunit_state.sink_length))
+    {
+        ucunit_sink_drain();
+    }
+}
+
+void UCUNIT_SinkWriteString(const char * msg)
+{
+    while (0 != *msg)
+    {
+        ucunit_sink_put(*msg++);
+    }
+}
+
+void UCUNIT_SinkWriteString_P(const char * msg)
+{
+#ifdef UCUNIT_PROGMEM_STRINGS
+    char c;
+
+    while (0 != (c = (char)pgm_read_byte(msg)))
+    {
+        ucunit_sink_put(c);
+        msg++;
+    }
+#else
+    UCUNIT_SinkWriteString(msg);
+#endif
+}
+
+void UCUNIT_SinkWriteInt(int n)
+{
+    char buffer[UCUNIT_FORMAT_BUFFER_SIZE];
+
+    UCUNIT_FormatS32(buffer, n);
+    UCUNIT_SinkWriteString(buffer);
+}
+
+void UCUNIT_SinkWriteByte(unsigned char b)
+{
+    ucunit_sink_put((char)b);
+}
+
+ucunit_sink_t * UCUNIT_SetSink(ucunit_sink_t * sink)
+{
+    ucunit_sink_t * previous = ucunit_current_sink();
+
+    UCUNIT_FlushSink();
+    ucunit_state.sink = sink;
+    return previous;
+}
+
+void UCUNIT_FlushSink(void)
+{
+    ucunit_sink_t * sink = ucunit_current_sink();
+
+    ucunit_sink_drain();
+    sink->flush(sink);
+}
+
+void UCUNIT_CloseSink(void)
+{
+    ucunit_sink_t * sink = ucunit_current_sink();
+
+    UCUNIT_FlushSink();
+    sink->close(sink);
+    ucunit_state.sink = NULL;
+}
+
+static void ucunit_ram_write(ucunit_sink_t * sink, const char * buffer, int length)
+{
+    ucunit_ram_sink_t * ram = (ucunit_ram_sink_t *)sink;
+    int room = ram->size - 1 - ram->length;
+    int n;
+
+    if (length > room)
+    {
+        ram->dropped += (unsigned long)(length - room);
+        length = room;
+    }
+    for (n = 0; n < length; n++)
+    {
+        ram->buffer[ram->length++] = buffer[n];
+    }
+    ram->buffer[ram->length] = 0;
+}
+
+void UCUNIT_RamSinkInit(ucunit_ram_sink_t * ram, char * buffer, int size)
+{
+    ram->sink.write = ucunit_ram_write;
+    ram->sink.flush = ucunit_sink_nothing;
+    ram->sink.close = ucunit_sink_nothing;
+    ram->buffer = buffer;
+    ram->size = size;
+    ram->length = 0;
+    ram->dropped = 0;
+    buffer[0] = 0;
+}
+
+static void ucunit_tee_write(ucunit_sink_t * sink, const char * buffer, int length)
+{
+    ucunit_tee_sink_t * tee = (ucunit_tee_sink_t *)sink;
+
+    tee->first->write(tee->first, buffer, length);
+    tee->second->write(tee->second, buffer, length);
+}
+
+static void ucunit_tee_flush(ucunit_sink_t * sink)
+{
+    ucunit_tee_sink_t * tee = (ucunit_tee_sink_t *)sink;
+
+    tee->first->flush(tee->first);
+    tee->second->flush(tee->second);
+}
+
+static void ucunit_tee_close(ucunit_sink_t * sink)
+{
+    ucunit_tee_sink_t * tee = (ucunit_tee_sink_t *)sink;
+
+    tee->first->close(tee->first);
+    tee->second->close(tee->second);
+}
+
+void UCUNIT_TeeSinkInit(ucunit_tee_sink_t * tee, ucunit_sink_t * first,
+                        ucunit_sink_t * second)
+{
+    tee->sink.write = ucunit_tee_write;
+    tee->sink.flush = ucunit_tee_flush;
+    tee->sink.close = ucunit_tee_close;
+    tee->first = first;
+    tee->second = second;
+}
+#endif
+
+#ifdef UCUNIT_REPORTERS
+/*****************************************************************************/
+/* Reporters                                                                 */
+/*****************************************************************************/
+
+/* State of the reporter */
+typedef struct
+{
+    int reporter; /* UCUNIT_REPORTER_xxx */
+    int started; /* TRUE after the header of the report */
+    ucunit_sink_t * sink; /* Sink of the report, NULL for the current sink */
+    ucunit_sink_t * output; /* Current sink outside of the testcase */
+    const char * name; /* Name of the running testcase, NULL if none */
+    ucunit_counter_t tests; /* Number of reported testcases */
+    ucunit_counter_t checks_failed; /* Failed checks seen by the reporter */
+    ucunit_counter_t outside; /* Failed checks outside of testcases */
+    ucunit_ram_sink_t log; /* Output of the running testcase */
+    char buffer[UCUNIT_REPORT_BUFFER_SIZE];
+} ucunit_reporter_t;
+
+static ucunit_reporter_t ucunit_reporter =
+{
+    UCUNIT_REPORTER, FALSE, NULL, NULL, NULL, 0, 0, 0,
+    { { NULL, NULL, NULL }, NULL, 0, 0, 0 }, { 0 }
+};
+
+/* Returns c, or '?' for control characters and bytes which are no
+   7-bit ASCII, so the report is valid UTF-8 */
+static char ucunit_report_char(char c)
+{
+    if ((((unsigned char)c < ' ') && ('\n' != c) && ('\t' != c)) ||
+        ((unsigned char)c > '~'))
+    {
+        return '?';
+    }
+    return c;
+}
+
+/* Writes text with the characters that are special in XML replaced */
+static void ucunit_write_xml(const char * text)
+{
+    char c;
+
+    while (0 != (c = *text++))
+    {
+        switch (c)
+        {
+        case '&':
+            UCUNIT_WriteString_P(UCUNIT_PSTR("&amp;"));
+            break;
+        case '<':
+            UCUNIT_WriteString_P(UCUNIT_PSTR("&lt;"));
+            break;
+        case '>':
+            UCUNIT_WriteString_P(UCUNIT_PSTR("&gt;"));
+            break;
+        case '"':
+            UCUNIT_WriteString_P(UCUNIT_PSTR("&quot;"));
+            break;
+        default:
+            UCUNIT_WriteByte((unsigned char)ucunit_report_char(c));
+            break;
+        }
+    }
+}
+
+/* Writes the name of a TAP test point, '#' would start a directive */
+static void ucunit_write_tap_name(const char * name)
+{
+    char c;
+
+    while (0 != (c = *name++))
+    {
+        if ('#' == c)
+        {
+            UCUNIT_WriteString_P(UCUNIT_PSTR("\\"));
+        }
+        UCUNIT_WriteByte(('\n' == c) ? ' ' : (unsigned char)c);
+    }
+}
+
+/* Writes the lines of text as TAP comments */
+static void ucunit_write_tap_comment(const char * text)
+{
+    int line_begin = TRUE;
+
+    while (0 != *text)
+    {
+        if (line_begin)
+        {
+            UCUNIT_WriteString_P(UCUNIT_PSTR("# "));
+        }
+        line_begin = ('\n' == *text);
+        UCUNIT_WriteByte((unsigned char)ucunit_report_char(*text++));
+    }
+    if (!line_begin)
+    {
+        UCUNIT_WriteString_P(UCUNIT_PSTR("\n"));
+    }
+}
+
+/* Writes value / unit with one decimal per power of 10 of unit */
+static void ucunit_write_decimal(unsigned long value, unsigned long unit)
+{
+    char buffer[UCUNIT_FORMAT_BUFFER_SIZE];
+
+    UCUNIT_FormatU32(buffer, value / unit);
+    UCUNIT_WriteString(buffer);
+    UCUNIT_WriteString_P(UCUNIT_PSTR("."));
+    UCUNIT_FormatU32(buffer, unit + value % unit);
+    UCUNIT_WriteString(buffer + 1); /* Without the leading 1 */
+}
+
+/* Elapsed time of the running testcase in microseconds */
+static unsigned long ucunit_testcase_us(void)
+{
+    System_Ticks elapsed = UCUNIT_GetTicks() - ucunit_state.testcase_start;
+    unsigned long rate = UCUNIT_GetTicksPerSecond();
+
+#ifdef UCUNIT_HAVE_INT64
+    return (unsigned long)(((unsigned long long)elapsed * 1000000UL) / rate);
+#else
+    return (rate >= 1000000UL) ? (unsigned long)elapsed / (rate / 1000000UL)
+                               : (unsigned long)elapsed * (1000000UL / rate);
+#endif
+}
+
+/* Selects the sink of the report and writes its header. Returns the
+   current sink, which ucunit_report_close() selects again. */
+static ucunit_sink_t * ucunit_report_open(void)
+{
+    ucunit_sink_t * output = ucunit_state.sink;
+
+    if (NULL != ucunit_reporter.sink)
+    {
+        UCUNIT_SetSink(ucunit_reporter.sink);
+    }
+    if (!ucunit_reporter.started)
+    {
+        if (NULL == ucunit_reporter.sink)
+        {
+            /* Like the text records, the report begins a new line */
+            UCUNIT_WriteString_P(UCUNIT_PSTR("\n"));
+        }
+        if (UCUNIT_REPORTER_JUNIT == ucunit_reporter.reporter)
+        {
+            UCUNIT_WriteString_P(UCUNIT_PSTR("<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+                                             "<testsuite name=\"uCUnit\">\n"));
+        }
+        ucunit_reporter.started = TRUE;
+    }
+    return output;
+}
+
+/* Flushes the report, so the CI sees each testcase when it ends */
+static void ucunit_report_close(ucunit_sink_t * output)
+{
+    UCUNIT_SetSink(output);
+}
+
+/* Writes the output of the testcase of ucunit_report_test() */
+static void ucunit_report_output(void)
+{
+    char buffer[UCUNIT_FORMAT_BUFFER_SIZE];
+    const ucunit_ram_sink_t * log = &ucunit_reporter.log;
+
+    if (UCUNIT_REPORTER_TAP == ucunit_reporter.reporter)
+    {
+        ucunit_write_tap_comment(log->buffer);
+    }
+    else
+    {
+        ucunit_write_xml(log->buffer);
+    }
+    if (log->dropped > 0)
+    {
+        if (UCUNIT_REPORTER_TAP == ucunit_reporter.reporter)
+        {
+            UCUNIT_WriteString_P(UCUNIT_PSTR("# "));
+        }
+        else if ((log->length > 0) && ('\n' != log->buffer[log->length - 1]))
+        {
+            UCUNIT_WriteString_P(UCUNIT_PSTR("\n"));
+        }
+        UCUNIT_WriteString_P(UCUNIT_PSTR("Report: dropped: "));
+        UCUNIT_FormatU32(buffer, log->dropped);
+        UCUNIT_WriteString(buffer);
+        UCUNIT_WriteString_P(UCUNIT_PSTR("\n"));
+    }
+}
+
+/* Writes a TAP test point or a JUnit testcase. The output of the
+   testcase is in the log, unless output is FALSE. */
+static void ucunit_report_test(const char * name, unsigned long us,
+                               ucunit_counter_t failed, int output)
+{
+    ucunit_sink_t * current = ucunit_report_open();
+
+    output = output && ((ucunit_reporter.log.length > 0) ||
+                        (ucunit_reporter.log.dropped > 0));
+    ucunit_reporter.tests++;
+    if (UCUNIT_REPORTER_TAP == ucunit_reporter.reporter)
+    {
+        UCUNIT_WriteString_P((0 == failed) ? UCUNIT_PSTR("ok ") : UCUNIT_PSTR("not ok "));
+        UCUNIT_WriteCounter(ucunit_reporter.tests);
+        UCUNIT_WriteString_P(UCUNIT_PSTR(" - "));
+        ucunit_write_tap_name(name);
+        UCUNIT_WriteString_P(UCUNIT_PSTR(" # time="));
+        ucunit_write_decimal(us, 1000UL);
+        UCUNIT_WriteString_P(UCUNIT_PSTR("ms\n"));
+        if (output)
+        {
+            ucunit_report_output();
+        }
+    }
+    else
+    {
+        UCUNIT_WriteString_P(UCUNIT_PSTR("  <testcase name=\""));
+        ucunit_write_xml(name);
+        UCUNIT_WriteString_P(UCUNIT_PSTR("\" time=\""));
+        ucunit_write_decimal(us, 1000000UL);
+        if ((0 == failed) && !output)
+        {
+            UCUNIT_WriteString_P(UCUNIT_PSTR("\"/>\n"));
+        }
+        else
+        {
+            UCUNIT_WriteString_P(UCUNIT_PSTR("\">\n"));
+            if (0 != failed)
+            {
+                UCUNIT_WriteString_P(UCUNIT_PSTR("    <failure message=\"Checks: failed: "));
+                UCUNIT_WriteCounter(failed);
+                UCUNIT_WriteString_P(UCUNIT_PSTR("\">"));
+            }
+            else
+            {
+                UCUNIT_WriteString_P(UCUNIT_PSTR("    <system-out>"));
+            }
+            if (output)
+            {
+                ucunit_report_output();
+            }
+            UCUNIT_WriteString_P((0 != failed) ? UCUNIT_PSTR("</failure>\n")
+                                               : UCUNIT_PSTR("</system-out>\n"));
+            UCUNIT_WriteString_P(UCUNIT_PSTR("  </testcase>\n"));
+        }
+    }
+    ucunit_report_close(current);
+}
+
+/* Counts the failed checks since the reporter saw the counter last,
+   they were outside of testcases */
+static void ucunit_report_outside(void)
+{
+    if (ucunit_state.statistics.checks_failed > ucunit_reporter.checks_failed)
+    {
+        ucunit_reporter.outside += ucunit_state.statistics.checks_failed -
+                                   ucunit_reporter.checks_failed;
+    }
+    ucunit_reporter.checks_failed = ucunit_state.statistics.checks_failed;
+}
+
+/* Starts to collect the output of a testcase in the log */
+static void ucunit_report_begin(const char * name)
+{
+    if (NULL == ucunit_reporter.name)
+    {
+        ucunit_report_outside();
+        ucunit_reporter.name = name;
+        ucunit_reporter.output = ucunit_state.sink;
+        UCUNIT_RamSinkInit(&ucunit_reporter.log, ucunit_reporter.buffer,
+                           UCUNIT_REPORT_BUFFER_SIZE);
+        UCUNIT_SetSink(&ucunit_reporter.log.sink);
+    }
+}
+
+/* Reports the running testcase with its output */
+static void ucunit_report_end(void)
+{
+    unsigned long us = ucunit_testcase_us();
+
+    if (NULL != ucunit_reporter.name)
+    {
+        UCUNIT_SetSink(ucunit_reporter.output);
+        ucunit_report_test(ucunit_reporter.name, us,
+                           ucunit_state.statistics.checks_failed -
+                           ucunit_state.testcases_failed_checks, TRUE);
+        ucunit_reporter.checks_failed = ucunit_state.statistics.checks_failed;
+        ucunit_reporter.name = NULL;
+    }
+}
+
+void UCUNIT_SetReporter(int reporter, ucunit_sink_t * sink)
+{
+    ucunit_reporter.reporter = reporter;
+    ucunit_reporter.sink = sink;
+}
+
+void UCUNIT_ReportTestcaseBegin(const char * name)
+{
+    if (UCUNIT_REPORTER_TEXT != ucunit_reporter.reporter)
+    {
+        ucunit_report_begin(name);
+        return;
+    }
+    UCUNIT_WriteString_P(UCUNIT_PSTR("\n======================================\n"));
+    UCUNIT_WriteString((char *)name);
+    UCUNIT_WriteString_P(UCUNIT_PSTR("\n======================================\n"));
+}
+
+void UCUNIT_ReportTestcaseEnd(const ucunit_site_t * site)
+{
+    if (UCUNIT_REPORTER_TEXT != ucunit_reporter.reporter)
+    {
+        ucunit_report_end();
+    }
+    else if (NULL == site)
+    {
+        UCUNIT_WriteString_P(UCUNIT_PSTR("Testcase passed.\n"));
+    }
+    else
+    {
+#ifndef UCUNIT_MODE_SILENT
+        UCUNIT_WriteSite(0, site);
+#endif
+    }
+}
+
+void UCUNIT_ReportTestcaseSeparator(void)
+{
+    if (UCUNIT_REPORTER_TEXT == ucunit_reporter.reporter)
+    {
+        UCUNIT_WriteString_P(UCUNIT_PSTR("======================================\n"));
+    }
+}
+
+int UCUNIT_ReportSummary(void)
+{
+    ucunit_sink_t * current;
+
+    if (UCUNIT_REPORTER_TEXT == ucunit_reporter.reporter)
+    {
+        return FALSE;
+    }
+    ucunit_report_outside();
+    if (ucunit_reporter.outside > 0)
+    {
+        ucunit_report_test("Checks outside of testcases", 0,
+                           ucunit_reporter.outside, FALSE);
+        ucunit_reporter.outside = 0;
+    }
+    current = ucunit_report_open();
+    if (UCUNIT_REPORTER_TAP == ucunit_reporter.reporter)
+    {
+        UCUNIT_WriteString_P(UCUNIT_PSTR("1.."));
+        UCUNIT_WriteCounter(ucunit_reporter.tests);
+        UCUNIT_WriteString_P(UCUNIT_PSTR("\n"));
+    }
+    else
+    {
+        UCUNIT_WriteString_P(UCUNIT_PSTR("</testsuite>\n"));
+    }
+    ucunit_report_close(current);
+    ucunit_reporter.started = FALSE;
+    ucunit_reporter.tests = 0;
+    return TRUE;
+}
+#endif
+
+/*****************************************************************************/
+/* Check sites                                                               */
+/*****************************************************************************/
+
+#if defined(UCUNIT_MODE_TOKENIZED)
+/* Writes a captured value as a typed value record */
+static void ucunit_write_value(int type, ucunit_value_t value)
+{
+    int size = 4;
+    int n;
+
+    if ((UCUNIT_VALUE_INT64 == type) || (UCUNIT_VALUE_UINT64 == type) ||
+        (UCUNIT_VALUE_DOUBLE == type))
+    {
+        size = 8;
+    }
+    else if ((UCUNIT_VALUE_PTR == type) && (sizeof(void *) > 4))
+    {
+        type = UCUNIT_VALUE_PTR64;
+        size = 8;
+    }
+    UCUNIT_WriteByte(UCUNIT_TOKEN_TYPED_VALUE);
+    UCUNIT_WriteByte((unsigned char)type);
+    for (n = 0; n < size; n++)
+    {
+        UCUNIT_WriteByte((unsigned char)(value & 0xFF));
+        value >>= 8;
+    }
+}
+#else
+/* Writes the message of a check site without the line end */
+static void ucunit_write_site(int passed, const ucunit_site_t * site)
+{
+    char buffer[UCUNIT_FORMAT_BUFFER_SIZE];
+
+    UCUNIT_WriteString_P(site->file);
+    UCUNIT_WriteString_P(UCUNIT_PSTR(":"));
+    UCUNIT_FormatS32(buffer, site->line);
+    UCUNIT_WriteString(buffer);
+    UCUNIT_WriteString_P(passed ? UCUNIT_PSTR(": passed:") : UCUNIT_PSTR(": failed:"));
+    UCUNIT_WriteString_P(site->msg);
+    UCUNIT_WriteString_P(UCUNIT_PSTR("("));
+    UCUNIT_WriteString_P(site->args);
+    UCUNIT_WriteString_P(UCUNIT_PSTR(")"));
+}
+
+/* Writes a captured value in the format of its type */
+static void ucunit_write_value(int type, ucunit_value_t value)
+{
+    char buffer[UCUNIT_FORMAT_BUFFER_SIZE];
+
+    switch (type)
+    {
+#ifdef UCUNIT_HAVE_INT64
+    case UCUNIT_VALUE_INT64:
+        UCUNIT_FormatS64(buffer, (long long)value);
+        break;
+    case UCUNIT_VALUE_UINT64:
+        UCUNIT_FormatU64(buffer, value);
+        break;
+    case UCUNIT_VALUE_PTR:
+        UCUNIT_WriteString_P(UCUNIT_PSTR("0x"));
+        UCUNIT_FormatHex64(buffer, value, 2 * (int)sizeof(void *));
+        break;
+#else
+    case UCUNIT_VALUE_PTR:
+        UCUNIT_WriteString_P(UCUNIT_PSTR("0x"));
+        UCUNIT_FormatHex32(buffer, value, 2 * (int)sizeof(void *));
+        break;
+#endif
+    case UCUNIT_VALUE_UINT:
+        UCUNIT_FormatU32(buffer, (ucunit_uint32_t)value);
+        break;
+    case UCUNIT_VALUE_HEX:
+        UCUNIT_WriteString_P(UCUNIT_PSTR("0x"));
+        UCUNIT_FormatHex32(buffer, (ucunit_uint32_t)value, 8);
+        break;
+#ifndef UCUNIT_NO_FLOAT
+    case UCUNIT_VALUE_FLOAT:
+        {
+            union { ucunit_uint32_t u; float f; } bits;
+
+            bits.u = (ucunit_uint32_t)value;
+            UCUNIT_FormatDouble(buffer, bits.f);
+        }
+        break;
+#ifdef UCUNIT_HAVE_INT64
+    case UCUNIT_VALUE_DOUBLE:
+        {
+            union { unsigned long long u; double d; } bits;
+
+            bits.u = value;
+            UCUNIT_FormatDouble(buffer, bits.d);
+        }
+        break;
+#endif
+#endif
+    default:
+        UCUNIT_FormatS32(buffer, (ucunit_int32_t)value);
+        break;
+    }
+    UCUNIT_WriteString(buffer);
+}
+
+/* Writes captured values as " [v1, v2]" */
+static void ucunit_write_values(int count, const unsigned char * types,
+                                const ucunit_value_t * values)
+{
+    int n;
+
+    for (n = 0; n < count; n++)
+    {
+        UCUNIT_WriteString_P((0 == n) ? UCUNIT_PSTR(" [") : UCUNIT_PSTR(", "));
+        ucunit_write_value(types[n], values[n]);
+    }
+    if (count > 0)
+    {
+        UCUNIT_WriteString_P(UCUNIT_PSTR("]"));
+    }
+}
+#endif
+
+/* Writes the message of a check site with its values, or appends it
+   to the log in UCUNIT_MODE_DEFERRED */
+static void ucunit_report(int passed, const ucunit_site_t * site, int count,
+                          const unsigned char * types, const ucunit_value_t * values)
+{
+#if defined(UCUNIT_MODE_TOKENIZED)
+    int n;
+
+    UCUNIT_WriteByte(passed ? UCUNIT_TOKEN_PASSED : UCUNIT_TOKEN_FAILED);
+    UCUNIT_WriteByte(site->file_id);
+    UCUNIT_WriteByte((unsigned char)(site->line & 0xFF));
+    UCUNIT_WriteByte((unsigned char)((site->line >> 8) & 0xFF));
+    for (n = 0; n < count; n++)
+    {
+        ucunit_write_value(types[n], values[n]);
+    }
+#elif defined(UCUNIT_MODE_DEFERRED)
+    if (ucunit_state.log_length < UCUNIT_LOG_SIZE)
+    {
+        ucunit_event_t * event = &ucunit_state.log[ucunit_state.log_length++];
+        int n;
+
+        event->site = site;
+        event->passed = (unsigned char)passed;
+        event->values = 0;
+        for (n = 0; (n < count) && (n < UCUNIT_LOG_VALUES); n++)
+        {
+            event->type[n] = types[n];
+            event->value[n] = values[n];
+            event->values++;
+        }
+        ucunit_state.log_last = event;
+    }
+    else
+    {
+        ucunit_state.log_dropped++;
+        ucunit_state.log_last = NULL;
+    }
+#else
+#ifdef UCUNIT_REPORTERS
+    if (passed && (UCUNIT_REPORTER_TEXT != ucunit_reporter.reporter))
+    {
+        return; /* The reporters show the failed checks only */
+    }
+#endif
+    ucunit_write_site(passed, site);
+    ucunit_write_values(count, types, values);
+    UCUNIT_WriteString_P(UCUNIT_PSTR("\n"));
+#endif
+}
+
+/* Passes or fails a check, see UCUNIT_PassCheck() and UCUNIT_FailCheck() */
+static void ucunit_check(int passed, const ucunit_site_t * site, int count,
+                         const unsigned char * types, const ucunit_value_t * values)
+{
+    if (passed)
+    {
+#ifdef UCUNIT_MODE_VERBOSE
+        ucunit_report(1, site, count, types, values);
+#endif
+        ucunit_state.statistics.checks_passed++;
+    }
+    else
+    {
+        if (UCUNIT_ACTION_SAFESTATE == ucunit_state.failure_action)
+        {
+            UCUNIT_FlushSink();
+            UCUNIT_Safestate();
+        }
+#ifndef UCUNIT_MODE_SILENT
+        ucunit_report(0, site, count, types, values);
+#endif
+        ucunit_state.statistics.checks_failed++;
+        ucunit_state.checklist_failed_checks++;
+    }
+#ifdef UCUNIT_CRASH_RECOVERY
+    ucunit_state.last_site = site;
+#endif
+}
+
+#ifdef UCUNIT_TEXT_SITES
+/* Site of the last check whose texts are not string literals */
+static ucunit_site_t ucunit_text_site;
+
+const ucunit_site_t * UCUNIT_TextSite(const char * file, int line,
+                                      const char * msg, const char * args)
+{
+    ucunit_text_site.file = file;
+    ucunit_text_site.line = line;
+    ucunit_text_site.msg = msg;
+    ucunit_text_site.args = args;
+    return &ucunit_text_site;
+}
+#endif
+
+void UCUNIT_WriteSite(int passed, const ucunit_site_t * site)
+{
+    ucunit_report(passed, site, 0, NULL, NULL);
+}
+
+void UCUNIT_CheckSite(int passed, const ucunit_site_t * site)
+{
+    ucunit_check(passed, site, 0, NULL, NULL);
+}
+
+void UCUNIT_CheckSiteValues(int passed, const ucunit_site_t * site, int type,
+                            ucunit_value_t a, ucunit_value_t b)
+{
+    unsigned char types[2];
+    ucunit_value_t values[2];
+
+    types[0] = (unsigned char)type;
+    types[1] = (unsigned char)type;
+    values[0] = a;
+    values[1] = b;
+    ucunit_check(passed, site, 2, types, values);
+}
+
+/*****************************************************************************/
+/* Memory checks                                                             */
+/*****************************************************************************/
+
+/* Word for word-at-a-time access, it may alias any other type */
+#ifdef __GNUC__
+typedef unsigned long __attribute__((__may_alias__)) ucunit_word_t;
+#else
+typedef unsigned long ucunit_word_t;
+#endif
+
+size_t UCUNIT_MemCompare(const void * a, const void * b, size_t len)
+{
+    const unsigned char * p = (const unsigned char *)a;
+    const unsigned char * q = (const unsigned char *)b;
+    size_t n = 0;
+
+#ifdef UCUNIT_USE_SSE2
+    for (; n + 16 <= len; n += 16)
+    {
+        __m128i x = _mm_loadu_si128((const __m128i *)(p + n));
+        __m128i y = _mm_loadu_si128((const __m128i *)(q + n));
+
+        if (0xFFFF != _mm_movemask_epi8(_mm_cmpeq_epi8(x, y)))
+        {
+            break;
+        }
+    }
+#else
+    if (0 == (((size_t)p ^ (size_t)q) & (sizeof(ucunit_word_t) - 1)))
+    {
+        /* Same alignment: compare up to the first word boundary, then
+           a word at a time */
+        for (; (n < len) && (0 != ((size_t)(p + n) & (sizeof(ucunit_word_t) - 1))); n++)
+        {
+            if (p[n] != q[n])
+            {
+                return n;
+            }
+        }
+        for (; n + sizeof(ucunit_word_t) <= len; n += sizeof(ucunit_word_t))
+        {
+            if (*(const ucunit_word_t *)(p + n) != *(const ucunit_word_t *)(q + n))
+            {
+                break;
+            }
+        }
+    }
+#endif
+
+    for (; n < len; n++)
+    {
+        if (p[n] != q[n])
+        {
+            return n;
+        }
+    }
+    return len;
+}
+
+size_t UCUNIT_MemCompareFill(const void * buf, unsigned char byte, size_t len)
+{
+    const unsigned char * p = (const unsigned char *)buf;
+    size_t n = 0;
+
+#ifdef UCUNIT_USE_SSE2
+    __m128i pattern = _mm_set1_epi8((char)byte);
+
+    for (; n + 16 <= len; n += 16)
+    {
+        __m128i x = _mm_loadu_si128((const __m128i *)(p + n));
+
+        if (0xFFFF != _mm_movemask_epi8(_mm_cmpeq_epi8(x, pattern)))
+        {
+            break;
+        }
+    }
+#else
+    ucunit_word_t pattern = ((ucunit_word_t)~0UL / 0xFF) * byte;
+
+    for (; (n < len) && (0 != ((size_t)(p + n) & (sizeof(ucunit_word_t) - 1))); n++)
+    {
+        if (p[n] != byte)
+        {
+            return n;
+        }
+    }
+    for (; n + sizeof(ucunit_word_t) <= len; n += sizeof(ucunit_word_t))
+    {
+        if (*(const ucunit_word_t *)(p + n) != pattern)
+        {
+            break;
+        }
+    }
+#endif
+
+    for (; n < len; n++)
+    {
+        if (p[n] != byte)
+        {
+            return n;
+        }
+    }
+    return len;
+}
+
+#if !defined(UCUNIT_MODE_SILENT) && !defined(UCUNIT_MODE_DEFERRED)
+/* Writes bytes start..end-1 of a block in hex, or the fill byte if
+   block is NULL */
+static void ucunit_write_hex_bytes(const unsigned char * block, unsigned char fill,
+                                   size_t start, size_t end)
+{
+    char buffer[UCUNIT_FORMAT_BUFFER_SIZE];
+    size_t n;
+
+    for (n = start; n < end; n++)
+    {
+        UCUNIT_FormatHex32(buffer, (NULL != block) ? block[n] : fill, 2);
+        UCUNIT_WriteString_P(UCUNIT_PSTR(" "));
+        UCUNIT_WriteString(buffer);
+    }
+    UCUNIT_WriteString_P(UCUNIT_PSTR("\n"));
+}
+#endif
+
+void UCUNIT_CheckMemSite(const ucunit_site_t * site, const void * expected,
+                         unsigned char fill, const void * actual, size_t len)
+{
+    size_t offset;
+    unsigned char type = UCUNIT_VALUE_UINT;
+    ucunit_value_t value;
+
+    if (NULL != expected)
+    {
+        offset = UCUNIT_MemCompare(expected, actual, len);
+    }
+    else
+    {
+        offset = UCUNIT_MemCompareFill(actual, fill, len);
+    }
+    if (offset == len)
+    {
+        ucunit_check(1, site, 0, NULL, NULL);
+        return;
+    }
+
+    value = (ucunit_value_t)offset;
+    ucunit_check(0, site, 1, &type, &value);
+
+#if !defined(UCUNIT_MODE_SILENT) && !defined(UCUNIT_MODE_DEFERRED)
+    {
+        char buffer[UCUNIT_FORMAT_BUFFER_SIZE];
+        size_t start = 0;
+        size_t end;
+
+        if (offset > UCUNIT_MEM_WINDOW / 2)
+        {
+            start = offset - UCUNIT_MEM_WINDOW / 2;
+        }
+        end = start + UCUNIT_MEM_WINDOW;
+        if (end > len)
+        {
+            end = len;
+        }
+
+        UCUNIT_WriteString_P(UCUNIT_PSTR("  bytes "));
+        UCUNIT_FormatU32(buffer, (unsigned long)start);
+        UCUNIT_WriteString(buffer);
+        UCUNIT_WriteString_P(UCUNIT_PSTR(".."));
+        UCUNIT_FormatU32(buffer, (unsigned long)(end - 1));
+        UCUNIT_WriteString(buffer);
+        UCUNIT_WriteString_P(UCUNIT_PSTR(":\n  expected:"));
+        ucunit_write_hex_bytes((const unsigned char *)expected, fill, start, end);
+        UCUNIT_WriteString_P(UCUNIT_PSTR("  actual:  "));
+        ucunit_write_hex_bytes((const unsigned char *)actual, 0, start, end);
+    }
+#endif
+}
+
+/*****************************************************************************/
+/* CRC32                                                                     */
+/*****************************************************************************/
+
+/* Reflected polynomial of CRC32 */
+#define UCUNIT_CRC32_POLYNOMIAL 0xEDB88320UL
+
+#ifdef UCUNIT_CRC32_SMALL
+/* CRC32 of each nibble */
+static const ucunit_uint32_t ucunit_crc32_table[16] =
+{
+    0x00000000UL, 0x1DB71064UL, 0x3B6E20C8UL, 0x26D930ACUL,
+    0x76DC4190UL, 0x6B6B51F4UL, 0x4DB26158UL, 0x5005713CUL,
+    0xEDB88320UL, 0xF00F9344UL, 0xD6D6A3E8UL, 0xCB61B38CUL,
+    0x9B64C2B0UL, 0x86D3D2D4UL, 0xA00AE278UL, 0xBDBDF21CUL
+};
+
+unsigned long UCUNIT_Crc32Update(unsigned long crc, const void * data, size_t len)
+{
+    const unsigned char * p = (const unsigned char *)data;
+    ucunit_uint32_t c = (ucunit_uint32_t)~crc;
+
+    while (len--)
+    {
+        c ^= *p++;
+        c = (c >> 4) ^ ucunit_crc32_table[c & 0x0F];
+        c = (c >> 4) ^ ucunit_crc32_table[c & 0x0F];
+    }
+    return (unsigned long)(~c & 0xFFFFFFFFUL);
+}
+#else
+/* Slicing-by-8 tables: table[k][b] is the CRC32 of byte b followed
+   by k zero bytes */
+static ucunit_uint32_t ucunit_crc32_table[8][256];
+static int ucunit_crc32_table_ready = 0;
+
+static void ucunit_crc32_init(void)
+{
+    int n;
+    int k;
+
+    for (n = 0; n < 256; n++)
+    {
+        ucunit_uint32_t c = (ucunit_uint32_t)n;
+
+        for (k = 0; k < 8; k++)
+        {
+            c = (c & 1) ? ((c >> 1) ^ UCUNIT_CRC32_POLYNOMIAL) : (c >> 1);
+        }
+        ucunit_crc32_table[0][n] = c;
+    }
+    for (n = 0; n < 256; n++)
+    {
+        for (k = 1; k < 8; k++)
+        {
+            ucunit_uint32_t c = ucunit_crc32_table[k - 1][n];
+
+            ucunit_crc32_table[k][n] = (c >> 8) ^ ucunit_crc32_table[0][c & 0xFF];
+        }
+    }
+    ucunit_crc32_table_ready = 1;
+}
+
+unsigned long UCUNIT_Crc32Update(unsigned long crc, const void * data, size_t len)
+{
+    const unsigned char * p = (const unsigned char *)data;
+    ucunit_uint32_t c = (ucunit_uint32_t)(~crc & 0xFFFFFFFFUL);
+
+    if (!ucunit_crc32_table_ready)
+    {
+        ucunit_crc32_init();
+    }
+
+    for (; len >= 8; len -= 8, p += 8)
+    {
+        /* The bytes are combined one by one, so this works on any
+           alignment and byte order */
+        c ^= (ucunit_uint32_t)p[0] | ((ucunit_uint32_t)p[1] << 8) |
+             ((ucunit_uint32_t)p[2] << 16) | ((ucunit_uint32_t)p[3] << 24);
+        c = ucunit_crc32_table[7][c & 0xFF] ^
+            ucunit_crc32_table[6][(c >> 8) & 0xFF] ^
+            ucunit_crc32_table[5][(c >> 16) & 0xFF] ^
+            ucunit_crc32_table[4][(c >> 24) & 0xFF] ^
+            ucunit_crc32_table[3][p[4]] ^
+            ucunit_crc32_table[2][p[5]] ^
+            ucunit_crc32_table[1][p[6]] ^
+            ucunit_crc32_table[0][p[7]];
+    }
+    while (len--)
+    {
+        c = (c >> 8) ^ ucunit_crc32_table[0][(c ^ *p++) & 0xFF];
+    }
+    return (unsigned long)(~c & 0xFFFFFFFFUL);
+}
+#endif
+
+/*****************************************************************************/
+/* Floating point and fixed point checks                                     */
+/*****************************************************************************/
+
+/* Passes or fails an array check, a failed check reports the maximum
+   error and its index */
+static void ucunit_check_array(int passed, const ucunit_site_t * site,
+                               unsigned char error_type, ucunit_value_t error,
+                               size_t index)
+{
+    unsigned char types[2];
+    ucunit_value_t values[2];
+
+    if (passed)
+    {
+        ucunit_check(1, site, 0, NULL, NULL);
+        return;
+    }
+    types[0] = error_type;
+    values[0] = error;
+    types[1] = UCUNIT_VALUE_UINT;
+    values[1] = (ucunit_value_t)index;
+    ucunit_check(0, site, 2, types, values);
+}
+
+#ifndef UCUNIT_NO_FLOAT
+/* Stores a floating point value as UCUNIT_VALUE_DOUBLE if it fits into
+   ucunit_value_t, else as UCUNIT_VALUE_FLOAT */
+static void ucunit_float_value(double d, unsigned char * type, ucunit_value_t * value)
+{
+#ifdef UCUNIT_HAVE_INT64
+    if (sizeof(double) == sizeof(unsigned long long))
+    {
+        union { double d; unsigned long long u; } bits;
+
+        bits.d = d;
+        *type = UCUNIT_VALUE_DOUBLE;
+        *value = bits.u;
+        return;
+    }
+#endif
+    {
+        union { float f; ucunit_uint32_t u; } bits;
+
+        bits.f = (float)d;
+        *type = UCUNIT_VALUE_FLOAT;
+        *value = bits.u;
+    }
+}
+
+/* Maps the sign-magnitude bits of a float to an unsigned number with
+   the same order, so the distance of two keys is the ULP distance */
+static ucunit_uint32_t ucunit_float_key(float f)
+{
+    union { float f; ucunit_uint32_t u; } bits;
+
+    bits.f = f;
+    if (bits.u & 0x80000000UL)
+    {
+        return (ucunit_uint32_t)(~bits.u & 0xFFFFFFFFUL);
+    }
+    return (ucunit_uint32_t)(bits.u | 0x80000000UL);
+}
+
+/* Equal values (also infinities) always pass, NaN never passes */
+static int ucunit_float_near(float expected, float actual, float abs_tol)
+{
+    float error = expected - actual;
+
+    if (error < 0)
+    {
+        error = -error;
+    }
+    return (expected == actual) || (error <= abs_tol);
+}
+
+void UCUNIT_CheckNearSite(const ucunit_site_t * site, double expected,
+                          double actual, double abs_tol)
+{
+    double error = expected - actual;
+    unsigned char types[2];
+    ucunit_value_t values[2];
+
+    if (error < 0)
+    {
+        error = -error;
+    }
+    ucunit_float_value(expected, &types[0], &values[0]);
+    ucunit_float_value(actual, &types[1], &values[1]);
+    ucunit_check((expected == actual) || (error <= abs_tol), site, 2, types, values);
+}
+
+void UCUNIT_CheckUlpSite(const ucunit_site_t * site, float expected,
+                         float actual, unsigned long max_ulps)
+{
+    ucunit_uint32_t a = ucunit_float_key(expected);
+    ucunit_uint32_t b = ucunit_float_key(actual);
+    ucunit_uint32_t distance = (a > b) ? (a - b) : (b - a);
+    unsigned char types[2];
+    ucunit_value_t values[2];
+
+    ucunit_float_value(expected, &types[0], &values[0]);
+    ucunit_float_value(actual, &types[1], &values[1]);
+    ucunit_check((expected == expected) && (actual == actual) &&
+                 ((expected == actual) || (distance <= max_ulps)),
+                 site, 2, types, values);
+}
+
+void UCUNIT_CheckArrayNearSite(const ucunit_site_t * site, const float * expected,
+                               const float * actual, size_t n, float abs_tol)
+{
+    size_t i = 0;
+    size_t max_index = 0;
+    float max_error = 0;
+    unsigned char type;
+    ucunit_value_t value;
+
+#ifdef UCUNIT_USE_SSE2
+    {
+        __m128 tol = _mm_set1_ps(abs_tol);
+        __m128 magnitude = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+
+        for (; i + 4 <= n; i += 4)
+        {
+            __m128 e = _mm_loadu_ps(expected + i);
+            __m128 a = _mm_loadu_ps(actual + i);
+            __m128 error = _mm_and_ps(_mm_sub_ps(e, a), magnitude);
+            __m128 near = _mm_or_ps(_mm_cmple_ps(error, tol), _mm_cmpeq_ps(e, a));
+
+            if (0x0F != _mm_movemask_ps(near))
+            {
+                break;
+            }
+        }
+    }
+#endif
+    for (; i < n; i++)
+    {
+        if (!ucunit_float_near(expected[i], actual[i], abs_tol))
+        {
+            break;
+        }
+    }
+    if (i == n)
+    {
+        ucunit_check_array(1, site, 0, 0, 0);
+        return;
+    }
+
+    /* Failed: find the maximum error, the first NaN is the maximum */
+    for (i = 0; i < n; i++)
+    {
+        float error = expected[i] - actual[i];
+
+        if (expected[i] == actual[i])
+        {
+            continue;
+        }
+        if (error < 0)
+        {
+            error = -error;
+        }
+        if (error != error)
+        {
+            max_error = error;
+            max_index = i;
+            break;
+        }
+        if (error > max_error)
+        {
+            max_error = error;
+            max_index = i;
+        }
+    }
+    ucunit_float_value(max_error, &type, &value);
+    ucunit_check_array(0, site, type, value, max_index);
+}
+#endif
+
+/* |a - b| of two values of up to 32 bits, without overflow */
+static unsigned long ucunit_fixed_error(long a, long b)
+{
+    if (a > b)
+    {
+        return (unsigned long)a - (unsigned long)b;
+    }
+    return (unsigned long)b - (unsigned long)a;
+}
+
+void UCUNIT_CheckFixedNearSite(const ucunit_site_t * site, long expected,
+                               long actual, unsigned long tol)
+{
+    UCUNIT_CheckSiteValues(ucunit_fixed_error(expected, actual) <= tol, site,
+                           UCUNIT_VALUE_INT, (ucunit_value_t)expected,
+                           (ucunit_value_t)actual);
+}
+
+void UCUNIT_CheckQ15ArrayNearSite(const ucunit_site_t * site, const ucunit_q15_t * expected,
+                                  const ucunit_q15_t * actual, size_t n, unsigned long tol)
+{
+    size_t i = 0;
+    size_t max_index = 0;
+    unsigned long max_error = 0;
+
+#ifdef UCUNIT_USE_SSE2
+    if (tol < 0x7FFFFFFFUL)
+    {
+        __m128i limit = _mm_set1_epi32((int)tol);
+
+        for (; i + 8 <= n; i += 8)
+        {
+            __m128i e = _mm_loadu_si128((const __m128i *)(expected + i));
+            __m128i a = _mm_loadu_si128((const __m128i *)(actual + i));
+            /* The difference needs 17 bits, so it is computed with
+               samples sign extended to 32 bits */
+            __m128i d_lo = _mm_sub_epi32(_mm_srai_epi32(_mm_unpacklo_epi16(e, e), 16),
+                                         _mm_srai_epi32(_mm_unpacklo_epi16(a, a), 16));
+            __m128i d_hi = _mm_sub_epi32(_mm_srai_epi32(_mm_unpackhi_epi16(e, e), 16),
+                                         _mm_srai_epi32(_mm_unpackhi_epi16(a, a), 16));
+            __m128i s_lo = _mm_srai_epi32(d_lo, 31);
+            __m128i s_hi = _mm_srai_epi32(d_hi, 31);
+
+            /* |d| = (d ^ s) - s with s = d >> 31 */
+            d_lo = _mm_sub_epi32(_mm_xor_si128(d_lo, s_lo), s_lo);
+            d_hi = _mm_sub_epi32(_mm_xor_si128(d_hi, s_hi), s_hi);
+            if (0 != _mm_movemask_epi8(_mm_or_si128(_mm_cmpgt_epi32(d_lo, limit),
+                                                    _mm_cmpgt_epi32(d_hi, limit))))
+            {
+                break;
+            }
+        }
+    }
+#endif
+    for (; i < n; i++)
+    {
+        if (ucunit_fixed_error(expected[i], actual[i]) > tol)
+        {
+            break;
+        }
+    }
+    if (i < n)
+    {
+        for (i = 0; i < n; i++)
+        {
+            unsigned long error = ucunit_fixed_error(expected[i], actual[i]);
+
+            if (error > max_error)
+            {
+                max_error = error;
+                max_index = i;
+            }
+        }
+    }
+    ucunit_check_array(max_error <= tol, site, UCUNIT_VALUE_UINT,
+                       (ucunit_value_t)max_error, max_index);
+}
+
+void UCUNIT_CheckQ31ArrayNearSite(const ucunit_site_t * site, const ucunit_q31_t * expected,
+                                  const ucunit_q31_t * actual, size_t n, unsigned long tol)
+{
+    size_t i;
+    size_t max_index = 0;
+    unsigned long max_error = 0;
+
+    for (i = 0; i < n; i++)
+    {
+        if (ucunit_fixed_error(expected[i], actual[i]) > tol)
+        {
+            break;
+        }
+    }
+    if (i < n)
+    {
+        for (i = 0; i < n; i++)
+        {
+            unsigned long error = ucunit_fixed_error(expected[i], actual[i]);
+
+            if (error > max_error)
+            {
+                max_error = error;
+                max_index = i;
+            }
+        }
+    }
+    ucunit_check_array(max_error <= tol, site, UCUNIT_VALUE_UINT,
+                       (ucunit_value_t)max_error, max_index);
+}
+
+#ifdef UCUNIT_MODE_DEFERRED
+/*****************************************************************************/
+/* Deferred log                                                              */
+/*****************************************************************************/
+
+void UCUNIT_FlushLog(void)
+{
+    char buffer[UCUNIT_FORMAT_BUFFER_SIZE];
+    int n;
+
+    for (n = 0; n < ucunit_state.log_length; n++)
+    {
+        const ucunit_event_t * event = &ucunit_state.log[n];
+
+        ucunit_write_site(event->passed, event->site);
+        ucunit_write_values(event->values, event->type, event->value);
+        UCUNIT_WriteString_P(UCUNIT_PSTR("\n"));
+    }
+    if (ucunit_state.log_dropped > 0)
+    {
+        UCUNIT_WriteString_P(UCUNIT_PSTR("Log: dropped: "));
+        UCUNIT_FormatU32(buffer, ucunit_state.log_dropped);
+        UCUNIT_WriteString(buffer);
+        UCUNIT_WriteString_P(UCUNIT_PSTR("\n"));
+    }
+    ucunit_state.log_length = 0;
+    ucunit_state.log_dropped = 0;
+    ucunit_state.log_last = NULL;
+}
+#endif
+
+/*****************************************************************************/
+/* Tracepoint coverage                                                       */
+/*****************************************************************************/
+
+/* Number of set bits of a coverage word */
+static int ucunit_popcount(ucunit_coverage_word_t word)
+{
+#if defined(__GNUC__) && !defined(__AVR__)
+    return __builtin_popcountl((unsigned long)word);
+#else
+    /* Number of set bits of each nibble */
+    static const unsigned char bits[16] =
+    {
+        0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4
+    };
+    int count = 0;
+
+    while (word)
+    {
+        count += bits[word & 0x0F];
+        word >>= 4;
+    }
+    return count;
+#endif
+}
+
+int UCUNIT_CountCoveredTracepoints(int first, int last)
+{
+    int count = 0;
+    int word;
+    int last_word;
+
+    if (first < 0)
+    {
+        first = 0;
+    }
+    if (last >= UCUNIT_MAX_TRACEPOINTS)
+    {
+        last = UCUNIT_MAX_TRACEPOINTS - 1;
+    }
+    if (first > last)
+    {
+        return 0;
+    }
+
+    word = first / UCUNIT_COVERAGE_WORD_BITS;
+    last_word = last / UCUNIT_COVERAGE_WORD_BITS;
+    for (; word <= last_word; word++)
+    {
+        ucunit_coverage_word_t bits = ucunit_state.coverage[word];
+
+        if (word == first / UCUNIT_COVERAGE_WORD_BITS)
+        {
+            /* Mask out the tracepoints below first */
+            bits &= (ucunit_coverage_word_t)(~(ucunit_coverage_word_t)0
+                    << (first % UCUNIT_COVERAGE_WORD_BITS));
+        }
+        if ((word == last_word) &&
+            ((last % UCUNIT_COVERAGE_WORD_BITS) != (UCUNIT_COVERAGE_WORD_BITS - 1)))
+        {
+            /* Mask out the tracepoints above last */
+            bits &= (ucunit_coverage_word_t)(~(~(ucunit_coverage_word_t)0
+                    << ((last % UCUNIT_COVERAGE_WORD_BITS) + 1)));
+        }
+        count += ucunit_popcount(bits);
+    }
+    return count;
+}
+
+void UCUNIT_WriteTracepointCoverage(int first, int last)
+{
+    char buffer[UCUNIT_FORMAT_BUFFER_SIZE];
+
+    UCUNIT_WriteString_P(UCUNIT_PSTR("Tracepoints "));
+    UCUNIT_FormatS32(buffer, first);
+    UCUNIT_WriteString(buffer);
+    UCUNIT_WriteString_P(UCUNIT_PSTR(".."));
+    UCUNIT_FormatS32(buffer, last);
+    UCUNIT_WriteString(buffer);
+    UCUNIT_WriteString_P(UCUNIT_PSTR(": covered: "));
+    UCUNIT_FormatS32(buffer, UCUNIT_CountCoveredTracepoints(first, last));
+    UCUNIT_WriteString(buffer);
+    UCUNIT_WriteString_P(UCUNIT_PSTR(" of "));
+    UCUNIT_FormatS32(buffer, (last >= first) ? (last - first + 1) : 0);
+    UCUNIT_WriteString(buffer);
+    UCUNIT_WriteString_P(UCUNIT_PSTR("\n"));
+}
+
+void UCUNIT_WriteTracepointReport(int first, int last)
+{
+    char buffer[UCUNIT_FORMAT_BUFFER_SIZE];
+    int index;
+    int uncovered = 0;
+
+    UCUNIT_WriteTracepointCoverage(first, last);
+    if (first < 0)
+    {
+        first = 0;
+    }
+    if (last >= UCUNIT_MAX_TRACEPOINTS)
+    {
+        last = UCUNIT_MAX_TRACEPOINTS - 1;
+    }
+
+#ifdef UCUNIT_TRACEPOINT_COUNTERS
+    UCUNIT_WriteString_P(UCUNIT_PSTR("Tracepoint hits:\n"));
+    for (index = first; index <= last; index++)
+    {
+        if (0 == ucunit_state.hits[index])
+        {
+            continue;
+        }
+        UCUNIT_WriteString_P(UCUNIT_PSTR("  "));
+        UCUNIT_FormatS32(buffer, index);
+        UCUNIT_WriteString(buffer);
+        UCUNIT_WriteString_P(UCUNIT_PSTR(": "));
+        UCUNIT_FormatU32(buffer, (unsigned long)ucunit_state.hits[index]);
+        UCUNIT_WriteString(buffer);
+        if (UCUNIT_HITS_MAX == ucunit_state.hits[index])
+        {
+            UCUNIT_WriteString_P(UCUNIT_PSTR("+"));
+        }
+        UCUNIT_WriteString_P(UCUNIT_PSTR("\n"));
+    }
+#endif
+
+    UCUNIT_WriteString_P(UCUNIT_PSTR("Tracepoints uncovered:"));
+    for (index = first; index <= last; index++)
+    {
+        if (0 == ((ucunit_state.coverage[index / UCUNIT_COVERAGE_WORD_BITS]
+                   >> (index % UCUNIT_COVERAGE_WORD_BITS)) & 0x01))
+        {
+            UCUNIT_WriteString_P(UCUNIT_PSTR(" "));
+            UCUNIT_FormatS32(buffer, index);
+            UCUNIT_WriteString(buffer);
+            uncovered++;
+        }
+    }
+    if (0 == uncovered)
+    {
+        UCUNIT_WriteString_P(UCUNIT_PSTR(" none"));
+    }
+    UCUNIT_WriteString_P(UCUNIT_PSTR("\n"));
+}
+
+/*****************************************************************************/
+/* Number formatting                                                         */
+/*****************************************************************************/
+
+static const char ucunit_hex_digits[] = "0123456789ABCDEF";
+
+#ifdef UCUNIT_FORMAT_NO_DIVIDE
+/* Powers of ten for the subtraction method */
+static const ucunit_uint32_t ucunit_pow10[] =
+{
+    1000000000UL, 100000000UL, 10000000UL, 1000000UL, 100000UL,
+    10000UL, 1000UL, 100UL, 10UL
+};
+#else
+/* Two decimal digits for each number from 0 to 99 */
+static const char ucunit_digit_pairs[] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+#endif
+
+/* Writes the decimal digits of value to p, at least width digits with
+   leading zeros. Returns the position behind the last digit. */
+static char * ucunit_format_digits(char * p, ucunit_uint32_t value, int width)
+{
+#ifdef UCUNIT_FORMAT_NO_DIVIDE
+    int i;
+    int started = FALSE;
+
+    for (i = 0; i < (int)(sizeof(ucunit_pow10) / sizeof(ucunit_pow10[0])); i++)
+    {
+        char digit = '0';
+
+        while (value >= ucunit_pow10[i])
+        {
+            value -= ucunit_pow10[i];
+            digit++;
+        }
+        if (started || (digit != '0') || ((10 - i) <= width))
+        {
+            *p++ = digit;
+            started = TRUE;
+        }
+    }
+    *p++ = (char)('0' + value);
+#else
+    char digits[10];
+    char * d = digits + sizeof(digits);
+
+    while (value >= 100)
+    {
+        const char * pair = &ucunit_digit_pairs[(value % 100) * 2];
+
+        value /= 100;
+        *--d = pair[1];
+        *--d = pair[0];
+    }
+    if (value >= 10)
+    {
+        *--d = ucunit_digit_pairs[value * 2 + 1];
+        *--d = ucunit_digit_pairs[value * 2];
+    }
+    else
+    {
+        *--d = (char)('0' + value);
+    }
+    while ((digits + sizeof(digits) - d) < width)
+    {
+        *--d = '0';
+    }
+    while (d < digits + sizeof(digits))
+    {
+        *p++ = *d++;
+    }
+#endif
+    return p;
+}
+
+int UCUNIT_FormatU32(char * buffer, ucunit_uint32_t value)
+{
+    char * p = ucunit_format_digits(buffer, value, 1);
+
+    *p = '\0';
+    return (int)(p - buffer);
+}
+
+int UCUNIT_FormatS32(char * buffer, ucunit_int32_t value)
+{
+    if (value < 0)
+    {
+        buffer[0] = '-';
+        return 1 + UCUNIT_FormatU32(buffer + 1,
+                                    (ucunit_uint32_t)0 - (ucunit_uint32_t)value);
+    }
+    return UCUNIT_FormatU32(buffer, (ucunit_uint32_t)value);
+}
+
+int UCUNIT_FormatHex32(char * buffer, ucunit_uint32_t value, int digits)
+{
+    int length = 1;
+    int i;
+
+    while ((length < 8) && (value >> (4 * length)))
+    {
+        length++;
+    }
+    if (length < digits)
+    {
+        length = digits;
+    }
+    for (i = length - 1; i >= 0; i--)
+    {
+        buffer[i] = ucunit_hex_digits[value & 0x0F];
+        value >>= 4;
+    }
+    buffer[length] = '\0';
+    return length;
+}
+
+#ifdef UCUNIT_HAVE_INT64
+int UCUNIT_FormatU64(char * buffer, unsigned long long value)
+{
+    /* Powers of ten above the 9 lower digits */
+    static const unsigned long long pow10[] =
+    {
+        10000000000000000000ULL, 1000000000000000000ULL,
+        100000000000000000ULL, 10000000000000000ULL, 1000000000000000ULL,
+        100000000000000ULL, 10000000000000ULL, 1000000000000ULL,
+        100000000000ULL, 10000000000ULL, 1000000000ULL
+    };
+    char * p = buffer;
+    int i;
+
+    if (value <= 0xFFFFFFFFUL)
+    {
+        return UCUNIT_FormatU32(buffer, (ucunit_uint32_t)value);
+    }
+
+    /* At most 9 subtractions per digit, no 64-bit division */
+    for (i = 0; i < (int)(sizeof(pow10) / sizeof(pow10[0])); i++)
+    {
+        char digit = '0';
+
+        while (value >= pow10[i])
+        {
+            value -= pow10[i];
+            digit++;
+        }
+        if ((digit != '0') || (p != buffer))
+        {
+            *p++ = digit;
+        }
+    }
+
+    /* The remaining value is below 10^9 */
+    p = ucunit_format_digits(p, (ucunit_uint32_t)value, 9);
+    *p = '\0';
+    return (int)(p - buffer);
+}
+
+int UCUNIT_FormatS64(char * buffer, long long value)
+{
+    if (value < 0)
+    {
+        buffer[0] = '-';
+        return 1 + UCUNIT_FormatU64(buffer + 1, 0ULL - (unsigned long long)value);
+    }
+    return UCUNIT_FormatU64(buffer, (unsigned long long)value);
+}
+
+int UCUNIT_FormatHex64(char * buffer, unsigned long long value, int digits)
+{
+    ucunit_uint32_t high = (ucunit_uint32_t)(value >> 32);
+
+    if (0 == high)
+    {
+        return UCUNIT_FormatHex32(buffer, (ucunit_uint32_t)value, digits);
+    }
+    digits = UCUNIT_FormatHex32(buffer, high, digits - 8);
+    return digits + UCUNIT_FormatHex32(buffer + digits,
+                                       (ucunit_uint32_t)value, 8);
+}
+#endif
+
+#ifndef UCUNIT_NO_FLOAT
+int UCUNIT_FormatDouble(char * buffer, double value)
+{
+    char * p = buffer;
+    unsigned long digits = 0;
+    int exponent = 0;
+
+    if (value != value)
+    {
+        buffer[0] = 'n';
+        buffer[1] = 'a';
+        buffer[2] = 'n';
+        buffer[3] = '\0';
+        return 3;
+    }
+    if (value < 0)
+    {
+        *p++ = '-';
+        value = -value;
+    }
+    /* Only infinity minus itself is not 0 */
+    if ((value - value) != 0)
+    {
+        p[0] = 'i';
+        p[1] = 'n';
+        p[2] = 'f';
+        p[3] = '\0';
+        return (int)(p - buffer) + 3;
+    }
+    if (value > 0)
+    {
+        /* Scale to 1 <= value < 10 */
+        while (value >= 10.0)
+        {
+            value /= 10.0;
+            exponent++;
+        }
+        while (value < 1.0)
+        {
+            value *= 10.0;
+            exponent--;
+        }
+        digits = (unsigned long)(value * 1000000.0 + 0.5);
+        if (digits >= 10000000UL)
+        {
+            digits /= 10;
+            exponent++;
+        }
+    }
+    p = ucunit_format_digits(p, digits / 1000000UL, 1);
+    *p++ = '.';
+    p = ucunit_format_digits(p, digits % 1000000UL, 6);
+    *p++ = 'e';
+    *p++ = (exponent < 0) ? '-' : '+';
+    p = ucunit_format_digits(p, (unsigned long)((exponent < 0) ? -exponent : exponent), 2);
+    *p = '\0';
+    return (int)(p - buffer);
+}
+#endif
+
+/*****************************************************************************/
+/* Timing Checks                                                             */
+/*****************************************************************************/
+
+System_Ticks UCUNIT_MicrosecondsToTicks(unsigned long us)
+{
+    unsigned long rate = UCUNIT_GetTicksPerSecond();
+
+#ifdef UCUNIT_HAVE_INT64
+    return (System_Ticks)(((unsigned long long)us * rate + 999999UL) / 1000000UL);
+#else
+    if (rate >= 1000000UL)
+    {
+        return (System_Ticks)(us * (rate / 1000000UL));
+    }
+    return (System_Ticks)((us + (1000000UL / rate) - 1) / (1000000UL / rate));
+#endif
+}
+
+/*****************************************************************************/
+/* Benchmarks                                                                */
+/*****************************************************************************/
+
+/* Number of significant bits of ticks, 0 for 0 */
+static int ucunit_bit_length(System_Ticks ticks)
+{
+    int length = 0;
+
+    while (ticks)
+    {
+        ticks >>= 1;
+        length++;
+    }
+    return length;
+}
+
+static void ucunit_write_ticks(System_Ticks ticks)
+{
+    char buffer[UCUNIT_FORMAT_BUFFER_SIZE];
+
+    UCUNIT_FormatU32(buffer, (unsigned long)ticks);
+    UCUNIT_WriteString(buffer);
+}
+
+void UCUNIT_BenchmarkAddSample(ucunit_benchmark_t * benchmark, System_Ticks ticks)
+{
+    int bin;
+
+    if (0 == benchmark->count)
+    {
+        /* Calibrate: cost of reading the tick counter twice */
+        int i;
+
+        benchmark->overhead = ~(System_Ticks)0;
+        for (i = 0; i < 4; i++)
+        {
+            System_Ticks start = UCUNIT_GetTicks();
+            System_Ticks overhead = UCUNIT_GetTicks() - start;
+
+            if (overhead < benchmark->overhead)
+            {
+                benchmark->overhead = overhead;
+            }
+        }
+    }
+
+    ticks = (ticks > benchmark->overhead) ? (ticks - benchmark->overhead) : 0;
+
+    if (0 == benchmark->count)
+    {
+        /* The first sample is placed in the middle of the histogram */
+        benchmark->min = ticks;
+        benchmark->max = ticks;
+        benchmark->sum = 0;
+        benchmark->base = ucunit_bit_length(ticks) - (UCUNIT_BENCHMARK_BINS / 2);
+        if (benchmark->base < 0)
+        {
+            benchmark->base = 0;
+        }
+        for (bin = 0; bin < UCUNIT_BENCHMARK_BINS; bin++)
+        {
+            benchmark->histogram[bin] = 0;
+        }
+    }
+
+    if (ticks < benchmark->min)
+    {
+        benchmark->min = ticks;
+    }
+    if (ticks > benchmark->max)
+    {
+        benchmark->max = ticks;
+    }
+    benchmark->sum += ticks;
+    benchmark->count++;
+
+    bin = ucunit_bit_length(ticks) - benchmark->base;
+    if (bin < 0)
+    {
+        bin = 0;
+    }
+    if (bin >= UCUNIT_BENCHMARK_BINS)
+    {
+        bin = UCUNIT_BENCHMARK_BINS - 1;
+    }
+    benchmark->histogram[bin]++;
+}
+
+void UCUNIT_BenchmarkWriteReport(ucunit_benchmark_t * benchmark, char * name)
+{
+    char buffer[UCUNIT_FORMAT_BUFFER_SIZE];
+    int bin;
+
+    UCUNIT_WriteString_P(UCUNIT_PSTR("Benchmark: "));
+    UCUNIT_WriteString(name);
+    UCUNIT_WriteString_P(UCUNIT_PSTR("\n  samples: "));
+    UCUNIT_FormatU32(buffer, benchmark->count);
+    UCUNIT_WriteString(buffer);
+    if (benchmark->count > 0)
+    {
+        UCUNIT_WriteString_P(UCUNIT_PSTR(" min: "));
+        ucunit_write_ticks(benchmark->min);
+        UCUNIT_WriteString_P(UCUNIT_PSTR(" max: "));
+        ucunit_write_ticks(benchmark->max);
+        UCUNIT_WriteString_P(UCUNIT_PSTR(" mean: "));
+        ucunit_write_ticks((System_Ticks)(benchmark->sum / benchmark->count));
+        UCUNIT_WriteString_P(UCUNIT_PSTR(" ticks"));
+
+        for (bin = 0; bin < UCUNIT_BENCHMARK_BINS; bin++)
+        {
+            int length = benchmark->base + bin;
+
+            if (0 == benchmark->histogram[bin])
+            {
+                continue;
+            }
+
+            /* Bin n holds samples of bit length base+n, the first and
+               the last bin also hold all shorter and longer samples. */
+            UCUNIT_WriteString_P(UCUNIT_PSTR("\n  ["));
+            if ((0 == bin) || (0 == length))
+            {
+                UCUNIT_WriteString_P(UCUNIT_PSTR("0"));
+            }
+            else
+            {
+                ucunit_write_ticks((System_Ticks)1 << (length - 1));
+            }
+            UCUNIT_WriteString_P(UCUNIT_PSTR(".."));
+            if ((UCUNIT_BENCHMARK_BINS - 1) == bin)
+            {
+                UCUNIT_WriteString_P(UCUNIT_PSTR("]: "));
+            }
+            else
+            {
+                ucunit_write_ticks((((System_Ticks)1 << length) - 1));
+                UCUNIT_WriteString_P(UCUNIT_PSTR("]: "));
+            }
+            UCUNIT_FormatU32(buffer, benchmark->histogram[bin]);
+            UCUNIT_WriteString(buffer);
+        }
+    }
+    UCUNIT_WriteString_P(UCUNIT_PSTR("\n"));
+    benchmark->count = 0;
+}
+
+#ifdef UCUNIT_TRACEPOINT_TIMESTAMPS
+/*****************************************************************************/
+/* Tracepoint timestamps                                                     */
+/*****************************************************************************/
+
+/* Number of valid entries and position of the oldest entry */
+static unsigned long ucunit_trace_length(unsigned long * oldest)
+{
+    if (ucunit_state.trace_next > UCUNIT_TRACE_BUFFER_SIZE)
+    {
+        *oldest = ucunit_state.trace_next - UCUNIT_TRACE_BUFFER_SIZE;
+        return UCUNIT_TRACE_BUFFER_SIZE;
+    }
+    *oldest = 0;
+    return ucunit_state.trace_next;
+}
+
+/* Entry n of the trace buffer, counted from the oldest entry */
+#define UCUNIT_TRACE_ENTRY(oldest, n) \
+    (&ucunit_state.trace[((oldest) + (n)) & (UCUNIT_TRACE_BUFFER_SIZE - 1)])
+
+static void ucunit_latency_add(ucunit_latency_t * latency, System_Ticks ticks)
+{
+    if ((0 == latency->count) || (ticks < latency->min))
+    {
+        latency->min = ticks;
+    }
+    if ((0 == latency->count) || (ticks > latency->max))
+    {
+        latency->max = ticks;
+    }
+    latency->sum += ticks;
+    latency->count++;
+}
+
+unsigned long UCUNIT_GetLatencyBetween(int a, int b, ucunit_latency_t * latency)
+{
+    unsigned long oldest;
+    unsigned long length = ucunit_trace_length(&oldest);
+    unsigned long n;
+    ucunit_trace_entry_t * start = 0;
+
+    latency->min = 0;
+    latency->max = 0;
+    latency->sum = 0;
+    latency->count = 0;
+
+    for (n = 0; n < length; n++)
+    {
+        ucunit_trace_entry_t * entry = UCUNIT_TRACE_ENTRY(oldest, n);
+
+        if ((b == entry->tracepoint) && (0 != start))
+        {
+            ucunit_latency_add(latency, entry->ticks - start->ticks);
+            start = 0;
+        }
+        if (a == entry->tracepoint)
+        {
+            start = entry;
+        }
+    }
+    return latency->count;
+}
+
+void UCUNIT_WriteTraceReport(void)
+{
+    char buffer[UCUNIT_FORMAT_BUFFER_SIZE];
+    unsigned long oldest;
+    unsigned long length = ucunit_trace_length(&oldest);
+    unsigned long n;
+    unsigned long m;
+
+    UCUNIT_WriteString_P(UCUNIT_PSTR("Trace: entries: "));
+    UCUNIT_FormatU32(buffer, length);
+    UCUNIT_WriteString(buffer);
+    UCUNIT_WriteString_P(UCUNIT_PSTR(" of "));
+    UCUNIT_FormatU32(buffer, ucunit_state.trace_next);
+    UCUNIT_WriteString(buffer);
+    UCUNIT_WriteString_P(UCUNIT_PSTR("\n"));
+
+    /* Each transition is reported at its first occurrence. The trace
+       buffer is small, so it is scanned again for every transition
+       instead of keeping a table of all pairs of tracepoints. */
+    for (n = 1; n < length; n++)
+    {
+        unsigned short from = UCUNIT_TRACE_ENTRY(oldest, n - 1)->tracepoint;
+        unsigned short to = UCUNIT_TRACE_ENTRY(oldest, n)->tracepoint;
+        ucunit_latency_t latency;
+
+        for (m = 1; m < n; m++)
+        {
+            if ((from == UCUNIT_TRACE_ENTRY(oldest, m - 1)->tracepoint) &&
+                (to == UCUNIT_TRACE_ENTRY(oldest, m)->tracepoint))
+            {
+                break;
+            }
+        }
+        if (m < n)
+        {
+            continue;
+        }
+
+        latency.min = 0;
+        latency.max = 0;
+        latency.sum = 0;
+        latency.count = 0;
+        for (m = n; m < length; m++)
+        {
+            ucunit_trace_entry_t * previous = UCUNIT_TRACE_ENTRY(oldest, m - 1);
+            ucunit_trace_entry_t * entry = UCUNIT_TRACE_ENTRY(oldest, m);
+
+            if ((from == previous->tracepoint) && (to == entry->tracepoint))
+            {
+                ucunit_latency_add(&latency, entry->ticks - previous->ticks);
+            }
+        }
+
+        UCUNIT_WriteString_P(UCUNIT_PSTR("  "));
+        UCUNIT_FormatU32(buffer, from);
+        UCUNIT_WriteString(buffer);
+        UCUNIT_WriteString_P(UCUNIT_PSTR("->"));
+        UCUNIT_FormatU32(buffer, to);
+        UCUNIT_WriteString(buffer);
+        UCUNIT_WriteString_P(UCUNIT_PSTR(": samples: "));
+        UCUNIT_FormatU32(buffer, latency.count);
+        UCUNIT_WriteString(buffer);
+        UCUNIT_WriteString_P(UCUNIT_PSTR(" min: "));
+        ucunit_write_ticks(latency.min);
+        UCUNIT_WriteString_P(UCUNIT_PSTR(" max: "));
+        ucunit_write_ticks(latency.max);
+        UCUNIT_WriteString_P(UCUNIT_PSTR(" mean: "));
+        ucunit_write_ticks((System_Ticks)(latency.sum / latency.count));
+        UCUNIT_WriteString_P(UCUNIT_PSTR(" ticks\n"));
+    }
+}
+#endif
+
+/*****************************************************************************/
+/* Test registry                                                             */
+/*****************************************************************************/
+
+/* A program without registered tests links without the table */
+#ifdef __GNUC__
+#define UCUNIT_WEAK __attribute__((weak))
+#else
+#define UCUNIT_WEAK
+#endif
+
+#ifdef UCUNIT_TEST_TABLE
+extern const ucunit_test_t * const ucunit_test_table[] UCUNIT_WEAK;
+#else
+extern const ucunit_test_t * const __start_ucunit_tests[] UCUNIT_WEAK;
+extern const ucunit_test_t * const __stop_ucunit_tests[] UCUNIT_WEAK;
+#endif
+
+static int ucunit_is_separator(char c)
+{
+    return (' ' == c) || (',' == c) || ('\t' == c) || ('\r' == c) || ('\n' == c);
+}
+
+static int ucunit_string_equal(const char * a, const char * b)
+{
+    while ((*a == *b) && (0 != *a))
+    {
+        a++;
+        b++;
+    }
+    return *a == *b;
+}
+
+/* Matches the word [text, text_end) against the pattern [pattern,
+   pattern_end) with the wildcards * and ?. After a mismatch the last
+   * takes one more character, so this needs no recursion. */
+static int ucunit_match(const char * pattern, const char * pattern_end,
+                        const char * text, const char * text_end)
+{
+    const char * star = 0;
+    const char * resume = 0;
+
+    while (text < text_end)
+    {
+        if ((pattern < pattern_end) && ('*' == *pattern))
+        {
+            star = ++pattern;
+            resume = text;
+        }
+        else if ((pattern < pattern_end) && (('?' == *pattern) || (*pattern == *text)))
+        {
+            pattern++;
+            text++;
+        }
+        else if (0 != star)
+        {
+            pattern = star;
+            text = ++resume;
+        }
+        else
+        {
+            return FALSE;
+        }
+    }
+    while ((pattern < pattern_end) && ('*' == *pattern))
+    {
+        pattern++;
+    }
+    return pattern == pattern_end;
+}
+
+/* Matches each word of a string against the pattern */
+static int ucunit_match_words(const char * pattern, const char * pattern_end,
+                              const char * words)
+{
+    while (0 != *words)
+    {
+        const char * word = words;
+
+        while ((0 != *words) && !ucunit_is_separator(*words))
+        {
+            words++;
+        }
+        if ((word != words) && ucunit_match(pattern, pattern_end, word, words))
+        {
+            return TRUE;
+        }
+        if (0 != *words)
+        {
+            words++;
+        }
+    }
+    return FALSE;
+}
+
+int UCUNIT_MatchTest(const ucunit_test_t * test, const char * filter)
+{
+    int included = FALSE;
+    int selected = FALSE;
+
+    while (0 != *filter)
+    {
+        const char * word;
+        int excluded = FALSE;
+        int match;
+
+        if (ucunit_is_separator(*filter))
+        {
+            filter++;
+            continue;
+        }
+        if ('-' == *filter)
+        {
+            excluded = TRUE;
+            filter++;
+        }
+        word = filter;
+        while ((0 != *filter) && !ucunit_is_separator(*filter))
+        {
+            filter++;
+        }
+        if (word == filter)
+        {
+            continue;
+        }
+
+        if ('@' == *word)
+        {
+            match = ucunit_match_words(word + 1, filter, test->tags);
+        }
+        else
+        {
+            const char * name_end = test->name;
+
+            while (0 != *name_end)
+            {
+                name_end++;
+            }
+            match = ucunit_match(word, filter, test->name, name_end);
+        }
+
+        if (excluded)
+        {
+            if (match)
+            {
+                return FALSE;
+            }
+        }
+        else
+        {
+            included = TRUE;
+            selected = selected || match;
+        }
+    }
+    return !included || selected;
+}
+
+#if defined(UCUNIT_CRASH_RECOVERY) || defined(UCUNIT_PERSIST)
+/* Writes "file:line: failed:msg(name)" for a test that did not end,
+   msg is in program memory */
+static void ucunit_write_test_failed(const ucunit_test_t * test, const char * msg)
+{
+    char buffer[UCUNIT_FORMAT_BUFFER_SIZE];
+
+    UCUNIT_FlushDeferred();
+#ifdef UCUNIT_REPORTERS
+    if ((UCUNIT_REPORTER_TEXT != ucunit_reporter.reporter) &&
+        (NULL == ucunit_reporter.name))
+    {
+        /* The test did not begin its testcase, or before a reset */
+        ucunit_state.testcases_failed_checks = ucunit_state.statistics.checks_failed;
+        ucunit_state.testcase_start = UCUNIT_GetTicks();
+        ucunit_report_begin(test->name);
+    }
+#endif
+    UCUNIT_WriteString((char *)test->file);
+    UCUNIT_WriteString_P(UCUNIT_PSTR(":"));
+    UCUNIT_FormatS32(buffer, test->line);
+    UCUNIT_WriteString(buffer);
+    UCUNIT_WriteString_P(UCUNIT_PSTR(": failed:"));
+    UCUNIT_WriteString_P(msg);
+    UCUNIT_WriteString_P(UCUNIT_PSTR("("));
+    UCUNIT_WriteString((char *)test->name);
+    UCUNIT_WriteString_P(UCUNIT_PSTR(")"));
+}
+
+/* Fails the testcase of a test that did not end, like UCUNIT_TestcaseEnd() */
+static void ucunit_end_failed_test(void)
+{
+    UCUNIT_WriteString_P(UCUNIT_PSTR("\n"));
+    ucunit_state.statistics.checks_failed++;
+#ifdef UCUNIT_REPORTERS
+    if (UCUNIT_REPORTER_TEXT != ucunit_reporter.reporter)
+    {
+        ucunit_report_end();
+    }
+    else
+#endif
+    {
+        UCUNIT_WriteString_P(UCUNIT_PSTR("======================================\n"));
+        UCUNIT_WriteString_P(UCUNIT_PSTR("Testcase failed.\n"));
+        UCUNIT_WriteString_P(UCUNIT_PSTR("======================================\n"));
+    }
+    ucunit_state.statistics.testcases_failed++;
+    ucunit_state.failure_action = UCUNIT_ACTION_WARNING; /* Checklist ended, too */
+}
+#endif
+
+#ifdef UCUNIT_CRASH_RECOVERY
+/* Writes the signal and the last check site of a crashed test */
+static void ucunit_write_crash(const ucunit_test_t * test, int signal)
+{
+    char buffer[UCUNIT_FORMAT_BUFFER_SIZE];
+    const ucunit_site_t * site = ucunit_state.last_site;
+
+    ucunit_write_test_failed(test, UCUNIT_PSTR("Crash"));
+    UCUNIT_WriteString_P(UCUNIT_PSTR(" signal: "));
+    UCUNIT_FormatS32(buffer, signal);
+    UCUNIT_WriteString(buffer);
+    UCUNIT_WriteString_P(UCUNIT_PSTR(", last check: "));
+    if (NULL == site)
+    {
+        UCUNIT_WriteString_P(UCUNIT_PSTR("none"));
+    }
+    else
+    {
+#ifdef UCUNIT_MODE_TOKENIZED
+        UCUNIT_WriteString_P(UCUNIT_PSTR("file "));
+        UCUNIT_FormatS32(buffer, site->file_id);
+        UCUNIT_WriteString(buffer);
+#else
+        UCUNIT_WriteString_P(site->file);
+#endif
+        UCUNIT_WriteString_P(UCUNIT_PSTR(":"));
+        UCUNIT_FormatS32(buffer, site->line);
+        UCUNIT_WriteString(buffer);
+    }
+    ucunit_end_failed_test();
+}
+#endif
+
+#if defined(UCUNIT_TIMEOUTS) && defined(UCUNIT_CRASH_RECOVERY)
+/* Writes "failed:Timeout(name) elapsed: n ms, timeout: m ms" */
+static void ucunit_write_timeout(const ucunit_test_t * test, unsigned long timeout)
+{
+    char buffer[UCUNIT_FORMAT_BUFFER_SIZE];
+    System_Ticks elapsed = UCUNIT_GetTicks() - ucunit_state.testcase_start;
+    unsigned long rate = UCUNIT_GetTicksPerSecond();
+    unsigned long ms;
+
+#ifdef UCUNIT_HAVE_INT64
+    ms = (unsigned long)(((unsigned long long)elapsed * 1000UL) / rate);
+#else
+    ms = (rate >= 1000UL) ? (unsigned long)elapsed / (rate / 1000UL)
+                          : (unsigned long)elapsed * (1000UL / rate);
+#endif
+    ucunit_write_test_failed(test, UCUNIT_PSTR("Timeout"));
+    UCUNIT_WriteString_P(UCUNIT_PSTR(" elapsed: "));
+    UCUNIT_FormatU32(buffer, ms);
+    UCUNIT_WriteString(buffer);
+    UCUNIT_WriteString_P(UCUNIT_PSTR(" ms, timeout: "));
+    UCUNIT_FormatU32(buffer, timeout);
+    UCUNIT_WriteString(buffer);
+    UCUNIT_WriteString_P(UCUNIT_PSTR(" ms"));
+    ucunit_end_failed_test();
+}
+#endif
+
+void UCUNIT_RunTest(const ucunit_test_t * test)
+{
+#ifdef UCUNIT_CRASH_RECOVERY
+    int signal;
+
+    ucunit_state.last_site = NULL;
+    signal = UCUNIT_RunProtected(test->function);
+    if (0 != signal)
+    {
+#ifdef UCUNIT_TIMEOUTS
+        unsigned long timeout = ucunit_state.timeout;
+
+        /* The test did not reach UCUNIT_TestcaseEnd() */
+        UCUNIT_DisarmTimeout();
+        if (UCUNIT_SIGNAL_TIMEOUT == signal)
+        {
+            ucunit_write_timeout(test, timeout);
+        }
+        else
+#endif
+        {
+            ucunit_write_crash(test, signal);
+        }
+    }
+#else
+    test->function();
+#endif
+    UCUNIT_FlushSink();
+}
+
+/* Visitor of UCUNIT_ListTests() */
+static void ucunit_list_test(const ucunit_test_t * test, void * context)
+{
+    char buffer[UCUNIT_FORMAT_BUFFER_SIZE];
+
+    (void)context;
+    UCUNIT_WriteString((char *)test->file);
+    UCUNIT_WriteString_P(UCUNIT_PSTR(":"));
+    UCUNIT_FormatS32(buffer, test->line);
+    UCUNIT_WriteString(buffer);
+    UCUNIT_WriteString_P(UCUNIT_PSTR(": "));
+    UCUNIT_WriteString((char *)test->name);
+    UCUNIT_WriteString_P(UCUNIT_PSTR(" ["));
+    UCUNIT_WriteString((char *)test->tags);
+    UCUNIT_WriteString_P(UCUNIT_PSTR("]\n"));
+}
+
+#ifndef UCUNIT_PERSIST
+/* Visitor of UCUNIT_RunTests() */
+static void ucunit_run_test(const ucunit_test_t * test, void * context)
+{
+    (void)context;
+    UCUNIT_RunTest(test);
+}
+#endif
+
+/* Visitor for counting only */
+static void ucunit_count_test(const ucunit_test_t * test, void * context)
+{
+    (void)test;
+    (*(int *)context)++;
+}
+
+int UCUNIT_CountTests(void)
+{
+    int total = 0;
+
+    UCUNIT_ForEachTest("", ucunit_count_test, &total);
+    return total;
+}
+
+int UCUNIT_ForEachTest(const char * filter, ucunit_visitor_t visit, void * context)
+{
+    int count = 0;
+#ifdef UCUNIT_TEST_TABLE
+    const ucunit_test_t * const * entry = ucunit_test_table;
+
+    while ((0 != entry) && (0 != *entry))
+    {
+        if (UCUNIT_MatchTest(*entry, filter))
+        {
+            count++;
+            visit(*entry, context);
+        }
+        entry++;
+    }
+#else
+    const ucunit_test_t * const * group = __start_ucunit_tests;
+    const ucunit_test_t * const * end = __stop_ucunit_tests;
+
+    if (0 == group)
+    {
+        return 0;
+    }
+
+    /* The linker keeps the entries of a file together, but the compiler
+       may emit them in any order. So the entries of each file are
+       visited by ascending line, with the position as tie breaker. */
+    while (group < end)
+    {
+        const ucunit_test_t * const * group_end = group + 1;
+        const ucunit_test_t * const * last = 0;
+
+        while ((group_end < end) &&
+               ucunit_string_equal((*group_end)->file, (*group)->file))
+        {
+            group_end++;
+        }
+
+        for (;;)
+        {
+            const ucunit_test_t * const * next = 0;
+            const ucunit_test_t * const * entry;
+
+            for (entry = group; entry < group_end; entry++)
+            {
+                if ((0 != last) &&
+                    (((*entry)->line < (*last)->line) ||
+                     (((*entry)->line == (*last)->line) && (entry <= last))))
+                {
+                    continue; /* Already visited */
+                }
+                if ((0 == next) || ((*entry)->line < (*next)->line))
+                {
+                    next = entry;
+                }
+            }
+            if (0 == next)
+            {
+                break;
+            }
+            if (UCUNIT_MatchTest(*next, filter))
+            {
+                count++;
+                visit(*next, context);
+            }
+            last = next;
+        }
+        group = group_end;
+    }
+#endif
+    return count;
+}
+
+int UCUNIT_ListTests(const char * filter)
+{
+    char buffer[UCUNIT_FORMAT_BUFFER_SIZE];
+    int count;
+
+    UCUNIT_WriteString_P(UCUNIT_PSTR("\n"));
+    count = UCUNIT_ForEachTest(filter, ucunit_list_test, 0);
+    UCUNIT_WriteString_P(UCUNIT_PSTR("Tests: "));
+    UCUNIT_FormatS32(buffer, count);
+    UCUNIT_WriteString(buffer);
+    UCUNIT_WriteString_P(UCUNIT_PSTR(" of "));
+    UCUNIT_FormatS32(buffer, UCUNIT_CountTests());
+    UCUNIT_WriteString(buffer);
+    UCUNIT_WriteString_P(UCUNIT_PSTR("\n"));
+    return count;
+}
+
+/* Returns the text after the option name if the word at command is
+   the option, else 0 */
+static const char * ucunit_option(const char * command, const char * name)
+{
+    while ((0 != *name) && (*name == *command))
+    {
+        name++;
+        command++;
+    }
+    if ((0 == *name) &&
+        ((0 == *command) || ('=' == *command) || ucunit_is_separator(*command)))
+    {
+        return command;
+    }
+    return 0;
+}
+
+#ifdef UCUNIT_REPORTERS
+/* Selects the reporter of the option --report=name[:path], value is
+   the text after --report */
+static void ucunit_report_option(const char * value)
+{
+    static const char * const names[] = { "text", "tap", "junit" };
+    char path[UCUNIT_COMMAND_SIZE];
+    ucunit_sink_t * sink = NULL;
+    const char * end;
+    int reporter = UCUNIT_REPORTER_TEXT;
+    int length = 0;
+
+    for (;; reporter++)
+    {
+        const char * name = names[reporter];
+
+        end = ('=' == *value) ? value + 1 : value;
+        while ((0 != *name) && (*name == *end))
+        {
+            name++;
+            end++;
+        }
+        if ((0 == *name) &&
+            ((0 == *end) || (':' == *end) || ucunit_is_separator(*end)))
+        {
+            break;
+        }
+        if (UCUNIT_REPORTER_JUNIT == reporter)
+        {
+            UCUNIT_WriteString_P(UCUNIT_PSTR("\nReport: unknown reporter\n"));
+            return;
+        }
+    }
+    if (':' == *end)
+    {
+        while ((0 != *++end) && !ucunit_is_separator(*end) &&
+               (length < UCUNIT_COMMAND_SIZE - 1))
+        {
+            path[length++] = *end;
+        }
+        path[length] = 0;
+        sink = UCUNIT_OpenReport(path);
+        if (NULL == sink)
+        {
+            UCUNIT_WriteString_P(UCUNIT_PSTR("\nReport: cannot open: "));
+            UCUNIT_WriteString(path);
+            UCUNIT_WriteString_P(UCUNIT_PSTR("\n"));
+        }
+    }
+    UCUNIT_SetReporter(reporter, sink);
+}
+#endif
+
+#ifdef UCUNIT_PERSIST
+/* Progress record. Without UCUNIT_PERSIST_SYSTEM it is kept in RAM that
+   is not cleared at startup. */
+#ifdef UCUNIT_PERSIST_SYSTEM
+static ucunit_persist_t ucunit_persist;
+#else
+static ucunit_persist_t ucunit_persist UCUNIT_NOINIT;
+#endif
+
+/* Statistics before the first test of the run, they are not saved */
+static ucunit_statistics_t ucunit_persist_base;
+
+static unsigned long ucunit_persist_checksum(void)
+{
+    return UCUNIT_Crc32(&ucunit_persist, offsetof(ucunit_persist_t, checksum));
+}
+
+static void ucunit_save_persistent(int next, int running)
+{
+    ucunit_statistics_t * statistics = &ucunit_persist.statistics;
+
+    statistics->checks_failed = ucunit_state.statistics.checks_failed - ucunit_persist_base.checks_failed;
+    statistics->checks_passed = ucunit_state.statistics.checks_passed - ucunit_persist_base.checks_passed;
+    statistics->testcases_failed = ucunit_state.statistics.testcases_failed - ucunit_persist_base.testcases_failed;
+    statistics->testcases_passed = ucunit_state.statistics.testcases_passed - ucunit_persist_base.testcases_passed;
+    ucunit_persist.magic = UCUNIT_PERSIST_MAGIC;
+    ucunit_persist.next = next;
+    ucunit_persist.running = running;
+    ucunit_persist.timeout = 0;
+    ucunit_persist.checksum = ucunit_persist_checksum();
+#ifdef UCUNIT_PERSIST_SYSTEM
+    UCUNIT_SavePersistent(&ucunit_persist, sizeof(ucunit_persist));
+#endif
+}
+
+/* Returns TRUE if the record holds the progress of this suite */
+static int ucunit_load_persistent(unsigned long suite)
+{
+#ifdef UCUNIT_PERSIST_SYSTEM
+    if (!UCUNIT_LoadPersistent(&ucunit_persist, sizeof(ucunit_persist)))
+    {
+        return FALSE;
+    }
+#endif
+    return (UCUNIT_PERSIST_MAGIC == ucunit_persist.magic) &&
+           (ucunit_persist_checksum() == ucunit_persist.checksum) &&
+           (suite == ucunit_persist.suite);
+}
+
+void UCUNIT_ClearPersistent(void)
+{
+    ucunit_persist.magic = 0;
+#ifdef UCUNIT_PERSIST_SYSTEM
+    UCUNIT_SavePersistent(&ucunit_persist, sizeof(ucunit_persist));
+#endif
+}
+
+/* Visitor of UCUNIT_RunTests(), skips the tests run before the reset.
+   The record is saved before and after each test. If it still says
+   running after a reset, that test caused the reset and is failed
+   instead of run again. */
+static void ucunit_run_persistent(const ucunit_test_t * test, void * context)
+{
+    int * index = (int *)context;
+
+    if (*index == ucunit_persist.next)
+    {
+        if (ucunit_persist.running)
+        {
+#ifdef UCUNIT_TIMEOUTS
+            if (0 != ucunit_persist.timeout)
+            {
+                char buffer[UCUNIT_FORMAT_BUFFER_SIZE];
+
+                ucunit_write_test_failed(test, UCUNIT_PSTR("Timeout"));
+                UCUNIT_WriteString_P(UCUNIT_PSTR(" timeout: "));
+                UCUNIT_FormatU32(buffer, ucunit_persist.timeout);
+                UCUNIT_WriteString(buffer);
+                UCUNIT_WriteString_P(UCUNIT_PSTR(" ms, watchdog reset"));
+            }
+            else
+#endif
+            {
+                ucunit_write_test_failed(test, UCUNIT_PSTR("Reset"));
+            }
+            ucunit_end_failed_test();
+        }
+        else
+        {
+            ucunit_save_persistent(*index, TRUE);
+            UCUNIT_RunTest(test);
+        }
+        ucunit_save_persistent(*index + 1, FALSE);
+    }
+    (*index)++;
+}
+
+/* Runs the tests and continues an earlier run of the same suite */
+static int ucunit_run_tests_persistent(const char * filter)
+{
+    char buffer[UCUNIT_FORMAT_BUFFER_SIZE];
+    unsigned long suite;
+    int total = UCUNIT_CountTests();
+    int length = 0;
+    int index = 0;
+    int count = 0;
+
+    while (0 != filter[length])
+    {
+        length++;
+    }
+    suite = UCUNIT_Crc32Update(UCUNIT_Crc32(filter, (size_t)length), &total, sizeof(total));
+
+    UCUNIT_GetStatistics(&ucunit_persist_base);
+    if (ucunit_load_persistent(suite))
+    {
+        UCUNIT_MergeStatistics(&ucunit_persist.statistics);
+#ifdef UCUNIT_REPORTERS
+        /* The testcases before the reset were reported then */
+        ucunit_reporter.checks_failed = ucunit_state.statistics.checks_failed;
+        ucunit_reporter.tests = ucunit_state.statistics.testcases_failed +
+                                ucunit_state.statistics.testcases_passed;
+#endif
+        UCUNIT_ForEachTest(filter, ucunit_count_test, &count);
+        UCUNIT_WriteString_P(UCUNIT_PSTR("\nTests: resumed after reset at: "));
+        UCUNIT_FormatS32(buffer, ucunit_persist.next + 1);
+        UCUNIT_WriteString(buffer);
+        UCUNIT_WriteString_P(UCUNIT_PSTR(" of "));
+        UCUNIT_FormatS32(buffer, count);
+        UCUNIT_WriteString(buffer);
+        UCUNIT_WriteString_P(UCUNIT_PSTR("\n"));
+    }
+    else
+    {
+        ucunit_persist.suite = suite;
+        ucunit_persist.next = 0;
+        ucunit_persist.running = FALSE;
+    }
+
+    count = UCUNIT_ForEachTest(filter, ucunit_run_persistent, &index);
+    UCUNIT_ClearPersistent();
+    return count;
+}
+#endif
+
+#ifdef UCUNIT_TIMEOUTS
+void UCUNIT_ArmTimeout(unsigned long ms)
+{
+    ucunit_state.timeout = ms;
+    if (0 != ms)
+    {
+#ifdef UCUNIT_PERSIST
+        /* A watchdog reset ends the run, the record tells it was a timeout */
+        if ((UCUNIT_PERSIST_MAGIC == ucunit_persist.magic) && ucunit_persist.running)
+        {
+            ucunit_persist.timeout = ms;
+            ucunit_persist.checksum = ucunit_persist_checksum();
+#ifdef UCUNIT_PERSIST_SYSTEM
+            UCUNIT_SavePersistent(&ucunit_persist, sizeof(ucunit_persist));
+#endif
+        }
+#endif
+        UCUNIT_StartTimeout(ms);
+    }
+}
+
+void UCUNIT_DisarmTimeout(void)
+{
+    if (0 != ucunit_state.timeout)
+    {
+        UCUNIT_StopTimeout();
+        ucunit_state.timeout = 0;
+    }
+}
+#endif
+
+int UCUNIT_RunTests(const char * command)
+{
+    char buffer[UCUNIT_FORMAT_BUFFER_SIZE];
+    const char * filter = command;
+    const char * value;
+    int list = FALSE;
+    int jobs = 1;
+    int count = 0;
+
+    /* Options come before the filter */
+    for (;;)
+    {
+        while (ucunit_is_separator(*filter))
+        {
+            filter++;
+        }
+        if (0 != (value = ucunit_option(filter, "--list")))
+        {
+            list = TRUE;
+        }
+        else if (0 != (value = ucunit_option(filter, "--jobs")))
+        {
+            jobs = 0; /* One per CPU */
+            if ('=' == *value)
+            {
+                while (('0' <= *++value) && ('9' >= *value))
+                {
+                    jobs = jobs * 10 + (*value - '0');
+                }
+            }
+        }
+#ifdef UCUNIT_REPORTERS
+        else if (0 != (value = ucunit_option(filter, "--report")))
+        {
+            ucunit_report_option(value);
+        }
+#endif
+        else
+        {
+            break;
+        }
+        filter = value;
+        while ((0 != *filter) && !ucunit_is_separator(*filter))
+        {
+            filter++;
+        }
+    }
+
+    if (list)
+    {
+        return UCUNIT_ListTests(filter);
+    }
+
+    if (0 != *filter)
+    {
+        UCUNIT_WriteString_P(UCUNIT_PSTR("\nTests: selected: "));
+        UCUNIT_ForEachTest(filter, ucunit_count_test, &count);
+        UCUNIT_FormatS32(buffer, count);
+        UCUNIT_WriteString(buffer);
+        UCUNIT_WriteString_P(UCUNIT_PSTR(" of "));
+        UCUNIT_FormatS32(buffer, UCUNIT_CountTests());
+        UCUNIT_WriteString(buffer);
+        UCUNIT_WriteString_P(UCUNIT_PSTR(" ("));
+        UCUNIT_WriteString((char *)filter);
+        UCUNIT_WriteString_P(UCUNIT_PSTR(")\n"));
+    }
+#ifdef UCUNIT_PARALLEL
+    if (1 != jobs)
+    {
+        UCUNIT_FlushSink();
+        return UCUNIT_RunParallel(filter, jobs);
+    }
+#else
+    (void)jobs;
+#endif
+#ifdef UCUNIT_PERSIST
+    return ucunit_run_tests_persistent(filter);
+#else
+    return UCUNIT_ForEachTest(filter, ucunit_run_test, 0);
+#endif
+}
@@ -59,6 +59,21 @@
  */
 #define UCUNIT_WriteString(msg)    System_WriteString(msg)
 
+/**
+ * @Macro:       UCUNIT_WriteString_P(msg)
+ *
+ * @Description: Encapsulates a function which is called for
+ *               writing a message string in program memory to the
+ *               host computer.
+ *
+ * @param msg:   Message which shall be written, see UCUNIT_PSTR(s).
+ *
+ * @Remarks:     On targets without UCUNIT_PROGMEM_STRINGS the string
+ *               is in RAM, just write it like UCUNIT_WriteString(msg).
+ *               On AVR read it with pgm_read_byte().
+ */
+#define UCUNIT_WriteString_P(msg)  System_WriteString_P(msg)
+
 /**
  * @Macro:       UCUNIT_WriteInt(n)
  *
@@ -77,6 +92,35 @@
  */
 #define UCUNIT_WriteInt(n)    System_WriteInt(n)
 
+/**
+ * @Macro:       UCUNIT_WriteByte(b)
+ *
+ * @Description: Encapsulates a function which is called for
+ *               writing a single raw byte to the host computer.
+ *
+ * @param b:     Byte which shall be written. Any value from 0x00
+ *               to 0xFF must be transmitted unchanged.
+ *
+ * @Remarks:     This is only used in UCUNIT_MODE_TOKENIZED for
+ *               writing binary records. Implement a function to
+ *               write one byte to your serial device or network.
+ */
+#define UCUNIT_WriteByte(b)    System_WriteByte(b)
+
+/**
+ * @Macro:       UCUNIT_WriteBuffer(buffer, length)
+ *
+ * @Description: Encapsulates a function which is called for
+ *               writing a buffer of characters to the host computer.
+ *
+ * @param buffer: Characters which shall be written, not terminated.
+ * @param length: Number of characters.
+ *
+ * @Remarks:     This is only used by the system sink of UCUNIT_SINKS,
+ *               which writes the output a line at a time.
+ */
+#define UCUNIT_WriteBuffer(buffer, length)  System_WriteBuffer(buffer, length)
+
 /**
  * @Macro:       UCUNIT_Safestate()
  *
@@ -144,472 +188,2926 @@
 #define UCUNIT_Shutdown()          System_Shutdown()
 
 /**
- * Verbose Mode.
- * UCUNIT_MODE_SILENT: Checks are performed silently.
- * UCUNIT_MODE_NORMAL: Only checks that fail are displayes
- * UCUNIT_MODE_VERBOSE: Passed and failed checks are displayed
+ * @Macro:       UCUNIT_GetTicks()
+ *
+ * @Description: Encapsulates a function which returns the current
+ *               value of a free running tick counter.
+ *
+ * @Remarks:     Implement a function to read a cycle counter or a
+ *               hardware timer with the highest resolution available.
+ *               The counter may wrap around, time differences are
+ *               computed with unsigned arithmetic.
+ *
  */
-//#define UCUNIT_MODE_NORMAL
-#define UCUNIT_MODE_VERBOSE
+#define UCUNIT_GetTicks()          System_GetTicks()
 
 /**
- * Max. number of checkpoints. This may depend on your application
- * or limited by your RAM.
+ * @Macro:       UCUNIT_GetTicksPerSecond()
+ *
+ * @Description: Encapsulates a function which returns the frequency
+ *               of the tick counter of UCUNIT_GetTicks().
+ *
  */
-#define UCUNIT_MAX_TRACEPOINTS 16
-
-/*****************************************************************************/
-/* **** End of customizing area *****                                        */
-/*****************************************************************************/
-
-/*****************************************************************************/
-/* Some useful constants                                                     */
-/*****************************************************************************/
-
-#define UCUNIT_VERSION "v1.0" /* Version info */
-
-#ifndef NULL
-#define NULL (void *)0
-#endif
-
-#ifndef TRUE
-#define TRUE 1
-#endif
-
-#ifndef FALSE
-#define FALSE 0
-#endif
-
-/* Action to take if check fails */
-#define UCUNIT_ACTION_WARNING   0 /* Goes through the checks
-                                     with message depending on level */
-#define UCUNIT_ACTION_SHUTDOWN  1 /* Stops on the end of the checklist
-                                     if any check has failed */
-#define UCUNIT_ACTION_SAFESTATE 2 /* Goes in safe state if check fails */
-
-/*****************************************************************************/
-/* Variables */
-/*****************************************************************************/
-
-/* Variables for simple statistics */
-static int ucunit_checks_failed = 0; /* Numer of failed checks */
-static int ucunit_checks_passed = 0; /* Number of passed checks */
-
-static int ucunit_testcases_failed = 0; /* Number of failed test cases */
-static int ucunit_testcases_passed = 0; /* Number of passed test cases */
-static int ucunit_testcases_failed_checks = 0; /* Number of failed checks in a testcase */
-static int ucunit_checklist_failed_checks = 0; /* Number of failed checks in a checklist */
-static int ucunit_action = UCUNIT_ACTION_WARNING; /* Action to take if a check fails */
-static int ucunit_checkpoints[UCUNIT_MAX_TRACEPOINTS]; /* Max. number of tracepoints */
-static int ucunit_index = 0; /* Tracepoint index */
-
-/*****************************************************************************/
-/* Internal (private) Macros                                                 */
-/*****************************************************************************/
+#define UCUNIT_GetTicksPerSecond() System_GetTicksPerSecond()
 
 /**
- * @Macro:       UCUNIT_DefineToStringHelper(x)
+ * @Macro:       UCUNIT_ReadCommand(argc, argv, buffer, size)
  *
- * @Description: Helper macro for converting a define constant into
- *               a string.
+ * @Description: Encapsulates a function which reads the command for
+ *               UCUNIT_RunTests() from the host computer.
  *
- * @Param x:     Define value to convert.
+ * @Param argc:   Argument count of main().
+ * @Param argv:   Arguments of main().
+ * @Param buffer: Buffer for the command.
+ * @Param size:   Size of the buffer.
  *
- * @Remarks:     This macro is used by UCUNIT_DefineToString().
+ * @Remarks:     Implement a function which copies the command line
+ *               arguments or reads a line from your serial device
+ *               into buffer. Write an empty string if there is no
+ *               command, all tests are run then.
  *
  */
-#define UCUNIT_DefineToStringHelper(x)    #x
+#define UCUNIT_ReadCommand(argc, argv, buffer, size)                \
+    System_ReadCommand(argc, argv, buffer, size)
 
 /**
- * @Macro:       UCUNIT_DefineToString(x)
+ * @Macro:       UCUNIT_RunParallel(filter, jobs)
  *
- * @Description: Converts a define constant into a string.
+ * @Description: Encapsulates a function which runs the registered
+ *               tests matching the filter in several worker processes.
  *
- * @Param x:     Define value to convert.
+ * @Param filter: Filter, see UCUNIT_MatchTest().
+ * @Param jobs:   Number of workers, 0 for one per CPU.
  *
- * @Remarks:     This macro uses UCUNIT_DefineToStringHelper().
+ * @Remarks:     This is only used with UCUNIT_PARALLEL. Implement a
+ *               function which runs each test with UCUNIT_RunTest()
+ *               in one of the workers. The output of the tests must
+ *               be written in the order of the tests and the
+ *               statistics of the workers must be added with
+ *               UCUNIT_MergeStatistics(), so the result is the same
+ *               as if the tests ran one after the other.
  *
  */
-#define UCUNIT_DefineToString(x)   UCUNIT_DefineToStringHelper(x)
+#define UCUNIT_RunParallel(filter, jobs)  System_RunParallel(filter, jobs)
 
-#ifdef UCUNIT_MODE_VERBOSE
 /**
- * @Macro:       UCUNIT_WritePassedMsg(msg, args)
+ * @Macro:       UCUNIT_RunProtected(function)
  *
- * @Description: Writes a message that check has passed.
+ * @Description: Encapsulates a function which calls a test function
+ *               and returns to the caller even if the test crashes.
  *
- * @Param msg:   Message to write. This is the name of the called
- *               Check, without the substring UCUNIT_Check.
- * @Param args:  Argument list as string.
+ * @Param function: Test function.
  *
- * @Remarks:     This macro is used by UCUNIT_Check(). A message will
- *               only be written if verbose mode is set
- *               to UCUNIT_MODE_VERBOSE.
+ * @Return:      0 if the test returned, UCUNIT_SIGNAL_TIMEOUT if the
+ *               testcase timeout expired, else the number of the
+ *               signal or exception which ended it.
+ *
+ * @Remarks:     This is only used with UCUNIT_CRASH_RECOVERY.
  *
  */
-#define UCUNIT_WritePassedMsg(msg, args)                        \
-    do                                                          \
-    {                                                           \
-        UCUNIT_WriteString(__FILE__);                           \
-        UCUNIT_WriteString(":");                                \
-        UCUNIT_WriteString(UCUNIT_DefineToString(__LINE__));    \
-        UCUNIT_WriteString(": passed:");                        \
-        UCUNIT_WriteString(msg);                                \
-        UCUNIT_WriteString("(");                                \
-        UCUNIT_WriteString(args);                               \
-        UCUNIT_WriteString(")\n");                              \
-    } while(0)
-#else
-#define UCUNIT_WritePassedMsg(msg, args)
-#endif
+#define UCUNIT_RunProtected(function)     System_RunProtected(function)
 
-#ifdef UCUNIT_MODE_SILENT
-#define UCUNIT_WriteFailedMsg(msg, args)
-#else
 /**
- * @Macro:       UCUNIT_WriteFailedMsg(msg, args)
+ * @Macro:       UCUNIT_LoadPersistent(buffer, size)
  *
- * @Description: Writes a message that check has failed.
+ * @Description: Encapsulates a function which reads the progress
+ *               record of UCUNIT_PERSIST from non-volatile memory.
  *
- * @Param msg:   Message to write. This is the name of the called
- *               Check, without the substring UCUNIT_Check.
- * @Param args:  Argument list as string.
+ * @Param buffer: Destination.
+ * @Param size:   Size of the record.
  *
- * @Remarks:     This macro is used by UCUNIT_Check(). A message will
- *               only be written if verbose mode is set
- *               to UCUNIT_MODE_NORMAL and UCUNIT_MODE_VERBOSE.
+ * @Return:      TRUE if the record was read.
+ *
+ * @Remarks:     This is only used with UCUNIT_PERSIST_SYSTEM.
+ *               Implement a function to read the record from EEPROM,
+ *               flash or a file. uCUnit checks the record itself.
  *
  */
-#define UCUNIT_WriteFailedMsg(msg, args)                        \
-    do                                                          \
-    {                                                           \
-        UCUNIT_WriteString(__FILE__);                           \
-        UCUNIT_WriteString(":");                                \
-        UCUNIT_WriteString(UCUNIT_DefineToString(__LINE__));    \
-        UCUNIT_WriteString(": failed:");                        \
-        UCUNIT_WriteString(msg);                                \
-        UCUNIT_WriteString("(");                                \
-        UCUNIT_WriteString(args);                               \
-        UCUNIT_WriteString(")\n");                              \
-    } while(0)
-#endif
+#define UCUNIT_LoadPersistent(buffer, size)  System_LoadPersistent(buffer, size)
 
 /**
- * @Macro:       UCUNIT_FailCheck(msg, args)
+ * @Macro:       UCUNIT_SavePersistent(buffer, size)
  *
- * @Description: Fails a check.
+ * @Description: Encapsulates a function which writes the progress
+ *               record of UCUNIT_PERSIST to non-volatile memory.
  *
- * @Param msg:   Message to write. This is the name of the called
- *               Check, without the substring UCUNIT_Check.
- * @Param args:  Argument list as string.
+ * @Param buffer: Record to write.
+ * @Param size:   Size of the record.
  *
- * @Remarks:     This macro is used by UCUNIT_Check(). A message will
- *               only be written if verbose mode is set
- *               to UCUNIT_MODE_NORMAL and UCUNIT_MODE_VERBOSE.
+ * @Remarks:     This is only used with UCUNIT_PERSIST_SYSTEM. The
+ *               record is written before and after every test, so
+ *               only write the bytes that changed.
  *
  */
-#define UCUNIT_FailCheck(msg, args)                  \
-    do                                               \
-    {                                                \
-        if (UCUNIT_ACTION_SAFESTATE==ucunit_action)  \
-        {                                            \
-            UCUNIT_Safestate();                      \
-        }                                            \
-        UCUNIT_WriteFailedMsg(msg, args);            \
-        ucunit_checks_failed++;                      \
-        ucunit_checklist_failed_checks++;            \
-    } while(0)
+#define UCUNIT_SavePersistent(buffer, size)  System_SavePersistent(buffer, size)
 
 /**
- * @Macro:       UCUNIT_PassCheck(msg, args)
+ * @Macro:       UCUNIT_StartTimeout(ms)
  *
- * @Description: Passes a check.
+ * @Description: Encapsulates a function which starts a timer or
+ *               watchdog for the timeout of a testcase.
  *
- * @Param msg:   Message to write. This is the name of the called
- *               Check, without the substring UCUNIT_Check.
- * @Param args:  Argument list as string.
+ * @Param ms:    Timeout in milliseconds, > 0.
  *
- * @Remarks:     This macro is used by UCUNIT_Check(). A message will
- *               only be written if verbose mode is set
- *               to UCUNIT_MODE_VERBOSE.
+ * @Remarks:     This is only used with UCUNIT_TIMEOUTS. When the
+ *               timeout expires, return from UCUNIT_RunProtected()
+ *               with UCUNIT_SIGNAL_TIMEOUT, or reset the target and
+ *               let UCUNIT_PERSIST continue the run.
  *
  */
-#define UCUNIT_PassCheck(message, args)              \
-    do                                               \
-    {                                                \
-        UCUNIT_WritePassedMsg(message, args);        \
-        ucunit_checks_passed++;                      \
-    } while(0)
-
-/*****************************************************************************/
-/* Checklist Macros                                                          */
-/*****************************************************************************/
+#define UCUNIT_StartTimeout(ms)    System_StartTimeout(ms)
 
 /**
- * @Macro:       UCUNIT_ChecklistBegin(action)
- *
- * @Description: Begin of a checklist. You have to tell what action
- *               shall be taken if a check fails.
+ * @Macro:       UCUNIT_StopTimeout()
  *
- * @Param action: Action to take. This can be:
- *                * UCUNIT_ACTION_WARNING:   A warning message will be printed
- *                                           that a check has failed
- *                * UCUNIT_ACTION_SHUTDOWN:  The system will shutdown at
- *                                           the end of the checklist.
- *                * UCUNIT_ACTION_SAFESTATE: The system goes into the safe state
- *                                           on the first failed check.
-
- * @Remarks:     A checklist must be finished with UCUNIT_ChecklistEnd()
+ * @Description: Encapsulates a function which stops the timer or
+ *               watchdog of UCUNIT_StartTimeout().
  *
  */
-#define UCUNIT_ChecklistBegin(action)                           \
-    do                                                          \
-    {                                                           \
-        ucunit_action = action;                                 \
-        ucunit_checklist_failed_checks = 0;                     \
-    } while (0)
+#define UCUNIT_StopTimeout()       System_StopTimeout()
 
 /**
- * @Macro:       UCUNIT_ChecklistEnd()
+ * @Macro:       UCUNIT_OpenReport(path)
  *
- * @Description: End of a checklist. If the action was UCUNIT_ACTION_SHUTDOWN
- *               the system will shutdown.
+ * @Description: Encapsulates a function which opens a file for the
+ *               report of --report=tap:path or --report=junit:path.
  *
- * @Remarks:     A checklist must begin with UCUNIT_ChecklistBegin(action)
+ * @Param path:  Name of the file.
+ *
+ * @Return:      Sink which writes to the file, NULL if the target has
+ *               no files or the file could not be opened.
+ *
+ * @Remarks:     This is only used with UCUNIT_REPORTERS.
  *
  */
-#define UCUNIT_ChecklistEnd()                         \
-    if (ucunit_checklist_failed_checks!=0)            \
-    {                                                 \
-        UCUNIT_WriteFailedMsg("Checklist","");        \
-        if (UCUNIT_ACTION_SHUTDOWN==ucunit_action)    \
-        {                                             \
-            UCUNIT_Shutdown();                        \
-        }                                             \
-    }                                                 \
-    else                                              \
-    {                                                 \
-        UCUNIT_WritePassedMsg("Checklist","");        \
-    }
-
-/*****************************************************************************/
-/* Check Macros                                                              */
-/*****************************************************************************/
+#define UCUNIT_OpenReport(path)    System_OpenReport(path)
 
 /**
- * @Macro:       UCUNIT_Check(condition, msg, args)
- *
- * @Description: Checks a condition and prints a message.
- *
- * @Param msg:   Message to write.
- * @Param args:  Argument list as string
- *
- * @Remarks:     Basic check. This macro is used by all higher level checks.
- *
+ * Verbose Mode.
+ * UCUNIT_MODE_SILENT: Checks are performed silently.
+ * UCUNIT_MODE_NORMAL: Only checks that fail are displayes
+ * UCUNIT_MODE_VERBOSE: Passed and failed checks are displayed
  */
-#define UCUNIT_Check(condition, msg, args)             \
-    if ( (condition) ) { UCUNIT_PassCheck(msg, args); } else { UCUNIT_FailCheck(msg, args); }
+//#define UCUNIT_MODE_NORMAL
+#define UCUNIT_MODE_VERBOSE
 
 /**
- * @Macro:       UCUNIT_CheckIsEqual(expected,actual)
- *
- * @Description: Checks that actual value equals the expected value.
- *
- * @Param expected: Expected value.
- * @Param actual: Actual value.
- *
- * @Remarks:     This macro uses UCUNIT_Check(condition, msg, args).
- *
+ * Tokenized Mode.
+ * If defined, checks, testcases and the summary are written as compact
+ * binary records instead of text. A record holds only a tag, the file ID
+ * and the line number of the check site, so a check costs 4 bytes on the
+ * wire instead of the full file name, message and argument list.
+ * The verbose mode above still selects which records are written.
+ * Use tools/ucunit_sites.py to build the site table of your sources and
+ * tools/ucunit_decode.py to convert the records back into text.
  */
-#define UCUNIT_CheckIsEqual(expected,actual)         \
-    UCUNIT_Check( (expected) == (actual), "IsEqual", #expected "," #actual )
+//#define UCUNIT_MODE_TOKENIZED
 
 /**
- * @Macro:       UCUNIT_CheckIsNull(pointer)
- *
- * @Description: Checks that a pointer is NULL.
- *
- * @Param pointer: Pointer to check.
- *
- * @Remarks:     This macro uses UCUNIT_Check(condition, msg, args).
- *
+ * Deferred Mode.
+ * If defined, checks do not write their messages. They only append a
+ * record with a pointer to a static site descriptor to a log in RAM,
+ * so a check takes a few instructions and does not disturb the timing
+ * of the code under test. The log is written by UCUNIT_TestcaseEnd(),
+ * UCUNIT_ChecklistEnd() and UCUNIT_WriteSummary(). Records that do not
+ * fit into the UCUNIT_LOG_SIZE entries of the log are counted as
+ * dropped. UCUNIT_LOG_VALUES values can be captured per record.
+ * Combine it with UCUNIT_MODE_NORMAL to log only the failed checks.
  */
-#define UCUNIT_CheckIsNull(pointer)                  \
-    UCUNIT_Check( (pointer) == NULL, "IsNull", #pointer)
+//#define UCUNIT_MODE_DEFERRED
+#define UCUNIT_LOG_SIZE 32
+#define UCUNIT_LOG_VALUES 2
+
+#if defined(UCUNIT_MODE_DEFERRED) && defined(UCUNIT_MODE_TOKENIZED)
+#error "UCUNIT_MODE_DEFERRED and UCUNIT_MODE_TOKENIZED can not be combined"
+#endif
 
 /**
- * @Macro:       UCUNIT_CheckIsNotNull(pointer)
- *
- * @Description: Checks that a pointer is not NULL.
- *
- * @Param pointer: Pointer to check.
- *
- * @Remarks:     This macro uses UCUNIT_Check(condition, msg, args).
- *
+ * Compact Mode.
+ * If defined, a check expands to a single call of UCUNIT_CheckSite()
+ * with a pointer to a static site descriptor, instead of the inline
+ * pass/fail branch and message output at every call site. This
+ * reduces the code size of large testsuites a lot. The messages are
+ * the same as without this mode. All other modes can be combined with
+ * it.
  */
-#define UCUNIT_CheckIsNotNull(pointer)               \
-    UCUNIT_Check( (pointer) != NULL, "IsNotNull", #pointer)
+//#define UCUNIT_MODE_COMPACT
+
+/**
+ * File ID written in tokenized records. If your testsuite is split
+ * into several files, define a unique UCUNIT_FILE_ID in each file
+ * before including this header.
+ */
+#ifndef UCUNIT_FILE_ID
+#define UCUNIT_FILE_ID 0
+#endif
+
+/**
+ * Max. number of checkpoints. This may depend on your application
+ * or limited by your RAM.
+ */
+#define UCUNIT_MAX_TRACEPOINTS 16
+
+/**
+ * Tracepoint hit counters. If defined, every tracepoint also counts how
+ * often it was executed. The counters saturate at their maximum value.
+ * UCUNIT_WriteSummary() lists the hit counts and the uncovered
+ * tracepoints. UCUNIT_TRACEPOINT_COUNTER_BITS selects 8, 16 or 32-bit
+ * counters.
+ */
+//#define UCUNIT_TRACEPOINT_COUNTERS
+#define UCUNIT_TRACEPOINT_COUNTER_BITS 16
+
+/**
+ * Width of the check and test case counters, 16, 32 or 64 bits. Each
+ * check increments one of them, so use the native word size of small
+ * CPUs. 64-bit counters are for long soak runs and need 64-bit support.
+ * Define UCUNIT_MAX_CHECKS to the max. number of checks of a run, the
+ * build fails if the counters are too small for it.
+ */
+#ifndef UCUNIT_COUNTER_BITS
+#ifdef __AVR__
+#define UCUNIT_COUNTER_BITS 16
+#else
+#define UCUNIT_COUNTER_BITS 32
+#endif
+#endif
+//#define UCUNIT_MAX_CHECKS 10000UL
+
+/**
+ * Tracepoint timestamps. If defined, every tracepoint also writes its
+ * index and the tick counter into a ring buffer of
+ * UCUNIT_TRACE_BUFFER_SIZE entries (a power of 2). The buffer is used
+ * by UCUNIT_CheckLatencyBetween() and UCUNIT_WriteTraceReport(). When
+ * it is full, the oldest entries are overwritten.
+ */
+//#define UCUNIT_TRACEPOINT_TIMESTAMPS
+#define UCUNIT_TRACE_BUFFER_SIZE 32
+
+/**
+ * Word type of the tracepoint coverage bitmap. Use the natural word
+ * size of your CPU. A tracepoint needs one bit of RAM.
+ */
+#ifndef UCUNIT_COVERAGE_WORD
+#ifdef __AVR__
+#define UCUNIT_COVERAGE_WORD unsigned char
+#else
+#define UCUNIT_COVERAGE_WORD unsigned int
+#endif
+#endif
+
+/**
+ * Number of histogram bins of a benchmark. Each bin covers a power
+ * of two of elapsed ticks.
+ */
+#define UCUNIT_BENCHMARK_BINS 8
+
+/**
+ * Test registry. UCUNIT_TEST() registers a test function, which is run
+ * by UCUNIT_RunTests() if it matches the filter. With GCC on ELF
+ * targets the linker collects the tests from the section ucunit_tests.
+ * If UCUNIT_TEST_TABLE is defined, the tests are listed by hand with
+ * UCUNIT_TestTableBegin() instead. This is the default for AVR and all
+ * other compilers.
+ */
+//#define UCUNIT_TEST_TABLE
+
+/**
+ * Max. length of the command read by UCUNIT_ReadCommand(), including
+ * the terminating 0.
+ */
+#define UCUNIT_COMMAND_SIZE 64
+
+/**
+ * Parallel test runs. If defined, the option --jobs of UCUNIT_RunTests()
+ * runs the tests in worker processes with UCUNIT_RunParallel(). The
+ * i386 port supports it on POSIX hosts. Otherwise --jobs is ignored.
+ */
+//#define UCUNIT_PARALLEL
+
+/**
+ * Crash recovery. If defined, UCUNIT_RunTest() runs each test with
+ * UCUNIT_RunProtected(). A test which crashes fails with the signal and
+ * the last check site before the crash, and the run continues with
+ * the next test. Every check records its site for this. The i386 port
+ * supports it on POSIX hosts.
+ */
+//#define UCUNIT_CRASH_RECOVERY
+
+/**
+ * Resume after reset. If defined, UCUNIT_RunTests() keeps the statistics
+ * and the index of the next test in a record with a magic word and a
+ * CRC32, which survives a reset. After a watchdog reset or
+ * UCUNIT_Recover() the run continues with the next test and the summary
+ * includes the tests run before the reset. The test that was running
+ * at the reset is counted as failed. By default the record is kept in
+ * the .noinit section of the RAM, see UCUNIT_NOINIT. Define
+ * UCUNIT_PERSIST_SYSTEM to keep it in EEPROM, flash or a file with
+ * UCUNIT_LoadPersistent() and UCUNIT_SavePersistent() instead.
+ */
+//#define UCUNIT_PERSIST
+//#define UCUNIT_PERSIST_SYSTEM
+
+/**
+ * Testcase timeouts. If defined, a testcase can be given a timeout with
+ * UCUNIT_TestcaseBeginTimeout(), or all following testcases with
+ * UCUNIT_SetTestcaseTimeout(). A testcase that hangs is stopped when
+ * the timeout expires, fails with its elapsed time and the run
+ * continues with the next test. The i386 port uses a POSIX timer and
+ * needs UCUNIT_CRASH_RECOVERY; without it the run ends at the timeout
+ * and output still buffered by the testcase is lost. The AVR port uses
+ * the watchdog and needs UCUNIT_PERSIST to continue after the watchdog
+ * reset.
+ */
+//#define UCUNIT_TIMEOUTS
+
+/**
+ * Output sinks. If defined, the output is collected in a buffer of
+ * UCUNIT_SINK_BUFFER_SIZE characters and written to the current sink
+ * once per line instead of once per fragment. The default sink writes
+ * with UCUNIT_WriteBuffer(). UCUNIT_SetSink() selects another sink,
+ * e.g. a RAM buffer, a file descriptor or a tee of two sinks.
+ */
+//#define UCUNIT_SINKS
+#define UCUNIT_SINK_BUFFER_SIZE 64
+
+/**
+ * RAM capture. If defined, the output is written to the RAM buffer
+ * ucunit_capture of UCUNIT_CAPTURE_SIZE characters instead of the host.
+ * In a simulator, where each write is a system call, this is much
+ * faster. System_Shutdown() writes the buffer in one piece with
+ * UCUNIT_DumpCapture(). With UCUNIT_CAPTURE_NO_DUMP the host reads it
+ * from a memory image instead, see tools/ucunit_capture.py. This mode
+ * uses the sinks of UCUNIT_SINKS.
+ */
+//#define UCUNIT_CAPTURE
+//#define UCUNIT_CAPTURE_NO_DUMP
+#ifndef UCUNIT_CAPTURE_SIZE
+#define UCUNIT_CAPTURE_SIZE 4096
+#endif
+
+/**
+ * Reporters. If defined, the results of the testcases can be written
+ * as TAP or JUnit XML instead of the text records of the checks,
+ * testcases and the summary. A testcase is reported when it ends,
+ * with its duration and the output it wrote, so CI tools read the
+ * report while the run goes on. The output of a testcase is kept in
+ * a buffer of UCUNIT_REPORT_BUFFER_SIZE characters until then.
+ * UCUNIT_REPORTER selects the reporter at compile time, the option
+ * --report of UCUNIT_RunTests() or UCUNIT_SetReporter() at run time.
+ * This mode uses the sinks of UCUNIT_SINKS.
+ */
+//#define UCUNIT_REPORTERS
+//#define UCUNIT_REPORTER UCUNIT_REPORTER_TAP
+#ifndef UCUNIT_REPORT_BUFFER_SIZE
+#define UCUNIT_REPORT_BUFFER_SIZE 1024
+#endif
+
+/**
+ * Attribute of a variable which is not cleared at startup.
+ */
+#ifndef UCUNIT_NOINIT
+#define UCUNIT_NOINIT __attribute__((section(".noinit")))
+#endif
+
+/**
+ * Strings in program memory. On Harvard architectures like the AVR
+ * each string literal is copied to RAM at startup. If defined, the
+ * file names, messages and banners written by uCUnit stay in flash and
+ * are written with UCUNIT_WriteString_P(). Define UCUNIT_NO_PROGMEM to
+ * keep them in RAM.
+ */
+#if defined(__AVR__) && !defined(UCUNIT_NO_PROGMEM)
+#define UCUNIT_PROGMEM_STRINGS
+#endif
+
+#ifdef UCUNIT_PROGMEM_STRINGS
+#include <avr/pgmspace.h>
+#define UCUNIT_PROGMEM PROGMEM   /* Attribute of a string in flash */
+#define UCUNIT_PSTR(s) PSTR(s)   /* String literal in flash */
+#else
+#define UCUNIT_PROGMEM
+#define UCUNIT_PSTR(s) (s)
+#endif
+
+/*****************************************************************************/
+/* **** End of customizing area *****                                        */
+/*****************************************************************************/
+
+#if defined(UCUNIT_CAPTURE) && !defined(UCUNIT_SINKS)
+#define UCUNIT_SINKS
+#endif
+
+#if defined(UCUNIT_CAPTURE) && defined(UCUNIT_PARALLEL)
+#error "UCUNIT_PARALLEL needs the output of the workers, not UCUNIT_CAPTURE"
+#endif
+
+#if defined(UCUNIT_REPORTER) && !defined(UCUNIT_REPORTERS)
+#define UCUNIT_REPORTERS
+#endif
+
+#ifdef UCUNIT_REPORTERS
+#ifndef UCUNIT_SINKS
+#define UCUNIT_SINKS
+#endif
+#ifndef UCUNIT_REPORTER
+#define UCUNIT_REPORTER UCUNIT_REPORTER_TEXT
+#endif
+#if defined(UCUNIT_MODE_TOKENIZED) || defined(UCUNIT_MODE_DEFERRED)
+#error "UCUNIT_REPORTERS needs the text records of the checks"
+#endif
+#ifdef UCUNIT_PARALLEL
+#error "UCUNIT_REPORTERS writes one report per run, not one per worker"
+#endif
+#endif
+
+/*****************************************************************************/
+/* Some useful constants                                                     */
+/*****************************************************************************/
+
+#define UCUNIT_VERSION "v1.0" /* Version info */
+
+#ifndef NULL
+#define NULL (void *)0
+#endif
+
+#ifndef TRUE
+#define TRUE 1
+#endif
+
+#ifndef FALSE
+#define FALSE 0
+#endif
+
+/* Action to take if check fails */
+#define UCUNIT_ACTION_WARNING   0 /* Goes through the checks
+                                     with message depending on level */
+#define UCUNIT_ACTION_SHUTDOWN  1 /* Stops on the end of the checklist
+                                     if any check has failed */
+#define UCUNIT_ACTION_SAFESTATE 2 /* Goes in safe state if check fails */
+
+/* Reporters, see UCUNIT_REPORTERS */
+#define UCUNIT_REPORTER_TEXT  0 /* Text records of uCUnit */
+#define UCUNIT_REPORTER_TAP   1 /* Test Anything Protocol */
+#define UCUNIT_REPORTER_JUNIT 2 /* JUnit XML */
+
+/* Record tags of UCUNIT_MODE_TOKENIZED. Text written with
+   UCUNIT_WriteString() is 7-bit ASCII, so a byte with the most
+   significant bit set always starts a record. */
+#define UCUNIT_TOKEN_PASSED         0x80 /* Check passed: file, line */
+#define UCUNIT_TOKEN_FAILED         0x81 /* Check failed: file, line */
+#define UCUNIT_TOKEN_TESTCASE_BEGIN 0x82 /* Testcase begin: file, line */
+#define UCUNIT_TOKEN_TESTCASE_PASSED 0x83 /* Testcase passed: file, line */
+#define UCUNIT_TOKEN_TESTCASE_FAILED 0x84 /* Testcase failed: file, line */
+#define UCUNIT_TOKEN_SUMMARY        0x85 /* Summary: 4 x 32-bit counters */
+#define UCUNIT_TOKEN_VALUE          0x86 /* Value of the previous record:
+                                            32-bit */
+#define UCUNIT_TOKEN_TYPED_VALUE    0x87 /* Value of the previous record:
+                                            type, 4 or 8 bytes */
+
+/* Types of captured values. In UCUNIT_MODE_TOKENIZED pointers are
+   written as UCUNIT_VALUE_PTR (4 bytes) or UCUNIT_VALUE_PTR64. */
+#define UCUNIT_VALUE_INT    0 /* Signed, 32-bit */
+#define UCUNIT_VALUE_UINT   1 /* Unsigned, 32-bit */
+#define UCUNIT_VALUE_INT64  2 /* Signed, 64-bit */
+#define UCUNIT_VALUE_UINT64 3 /* Unsigned, 64-bit */
+#define UCUNIT_VALUE_PTR    4 /* Pointer, written in hex */
+#define UCUNIT_VALUE_PTR64  5 /* Pointer, 64-bit */
+#define UCUNIT_VALUE_HEX    6 /* Unsigned, 32-bit, written in hex */
+#define UCUNIT_VALUE_FLOAT  7 /* IEEE 754 single, 32-bit */
+#define UCUNIT_VALUE_DOUBLE 8 /* IEEE 754 double, 64-bit */
+
+/**
+ * 64-bit support. Define UCUNIT_NO_INT64 if your compiler does not
+ * support long long or if you do not want to link 64-bit arithmetic.
+ */
+#ifndef UCUNIT_NO_INT64
+#define UCUNIT_HAVE_INT64
+#endif
+
+/**
+ * Floating point support. Define UCUNIT_NO_FLOAT if you do not want to
+ * link floating point arithmetic. The fixed-point checks are always
+ * available.
+ */
+//#define UCUNIT_NO_FLOAT
+
+/**
+ * SIMD support. The memory and array checks use SSE2 on the host if
+ * the compiler supports it. Define UCUNIT_NO_SIMD to use the portable
+ * code instead.
+ */
+//#define UCUNIT_NO_SIMD
+
+/**
+ * Number of bytes written around the first difference of a failed
+ * memory check.
+ */
+#define UCUNIT_MEM_WINDOW 16
+
+#include <stddef.h>
+#include <limits.h>
+
+/*****************************************************************************/
+/* Variables */
+/*****************************************************************************/
+
+/* Smallest types with 32 bits */
+#if UINT_MAX >= 0xFFFFFFFFUL
+typedef unsigned int ucunit_uint32_t;
+typedef int ucunit_int32_t;
+#else
+typedef unsigned long ucunit_uint32_t;
+typedef long ucunit_int32_t;
+#endif
+
+/* Fails the build if the constant expression condition is false. It is
+   a typedef, so it can be used at file scope, even in C89. */
+#define UCUNIT_StaticAssert(condition, name) \
+    typedef char ucunit_static_assert_##name[(condition) ? 1 : -1]
+
+/* Check and test case counter */
+#if UCUNIT_COUNTER_BITS == 16
+typedef unsigned short ucunit_counter_t;
+#define UCUNIT_COUNTER_MAX 0xFFFFU
+#elif UCUNIT_COUNTER_BITS == 32
+#if UINT_MAX >= 0xFFFFFFFFUL
+typedef unsigned int ucunit_counter_t;
+#else
+typedef unsigned long ucunit_counter_t;
+#endif
+#define UCUNIT_COUNTER_MAX 0xFFFFFFFFUL
+#elif (UCUNIT_COUNTER_BITS == 64) && defined(UCUNIT_HAVE_INT64)
+typedef unsigned long long ucunit_counter_t;
+#define UCUNIT_COUNTER_MAX 0xFFFFFFFFFFFFFFFFULL
+#else
+#error "UCUNIT_COUNTER_BITS must be 16, 32 or 64 (with 64-bit support)"
+#endif
+
+UCUNIT_StaticAssert(sizeof(ucunit_counter_t) * CHAR_BIT >= UCUNIT_COUNTER_BITS,
+                    counter_bits);
+#ifdef UCUNIT_MAX_CHECKS
+UCUNIT_StaticAssert(UCUNIT_MAX_CHECKS <= UCUNIT_COUNTER_MAX, counter_margin);
+#endif
+
+/* Tracepoint coverage bitmap */
+typedef UCUNIT_COVERAGE_WORD ucunit_coverage_word_t;
+#define UCUNIT_COVERAGE_WORD_BITS ((int)(8 * sizeof(ucunit_coverage_word_t)))
+#define UCUNIT_COVERAGE_WORDS \
+    ((UCUNIT_MAX_TRACEPOINTS + UCUNIT_COVERAGE_WORD_BITS - 1) / UCUNIT_COVERAGE_WORD_BITS)
+
+#ifdef UCUNIT_TRACEPOINT_COUNTERS
+/* Tracepoint hit counter */
+#if UCUNIT_TRACEPOINT_COUNTER_BITS == 8
+typedef unsigned char ucunit_hits_t;
+#define UCUNIT_HITS_MAX 0xFFU
+#elif UCUNIT_TRACEPOINT_COUNTER_BITS == 16
+typedef unsigned short ucunit_hits_t;
+#define UCUNIT_HITS_MAX 0xFFFFU
+#elif UCUNIT_TRACEPOINT_COUNTER_BITS == 32
+typedef unsigned long ucunit_hits_t;
+#define UCUNIT_HITS_MAX 0xFFFFFFFFUL
+#else
+#error "UCUNIT_TRACEPOINT_COUNTER_BITS must be 8, 16 or 32"
+#endif
+UCUNIT_StaticAssert(sizeof(ucunit_hits_t) * CHAR_BIT >= UCUNIT_TRACEPOINT_COUNTER_BITS,
+                    hits_bits);
+#endif
+
+#ifdef UCUNIT_TRACEPOINT_TIMESTAMPS
+#if (UCUNIT_TRACE_BUFFER_SIZE & (UCUNIT_TRACE_BUFFER_SIZE - 1)) != 0
+#error "UCUNIT_TRACE_BUFFER_SIZE must be a power of 2"
+#endif
+
+/* Entry of the trace buffer */
+typedef struct
+{
+    System_Ticks ticks; /* Tick counter when the tracepoint was hit */
+    unsigned short tracepoint; /* Index of the tracepoint */
+} ucunit_trace_entry_t;
+#endif
+
+/* Fixed-point sample types: Q15 has 16 bits, Q31 has 32 bits */
+typedef short ucunit_q15_t;
+#if INT_MAX >= 0x7FFFFFFF
+typedef int ucunit_q31_t;
+#else
+typedef long ucunit_q31_t;
+#endif
+
+/* Captured value of a check, the bits of any value type */
+#ifdef UCUNIT_HAVE_INT64
+typedef unsigned long long ucunit_value_t;
+#else
+typedef unsigned long ucunit_value_t;
+#endif
+
+/* Static description of a check site. In UCUNIT_MODE_TOKENIZED the
+   host looks up the texts in the site table, so only the file ID and
+   the line are stored. */
+typedef struct
+{
+#ifdef UCUNIT_MODE_TOKENIZED
+    unsigned char file_id; /* UCUNIT_FILE_ID of the check */
+    int line; /* __LINE__ of the check */
+#else
+    const char * file; /* __FILE__ of the check, see UCUNIT_PSTR() */
+    int line; /* __LINE__ of the check */
+    const char * msg; /* Name of the check, see UCUNIT_PSTR() */
+    const char * args; /* Argument list as string, see UCUNIT_PSTR() */
+#endif
+} ucunit_site_t;
+
+/* Static description of a registered test, see UCUNIT_TEST() */
+typedef struct
+{
+    const char * name; /* Name of the test function */
+    const char * tags; /* Tags separated by blanks */
+    const char * file; /* __FILE__ of the test */
+    int line; /* __LINE__ of the test */
+    void (*function)(void); /* Test function */
+} ucunit_test_t;
+
+/* Function called by UCUNIT_ForEachTest() for each matching test */
+typedef void (*ucunit_visitor_t)(const ucunit_test_t * test, void * context);
+
+#ifdef UCUNIT_MODE_DEFERRED
+/* Record of the deferred log */
+typedef struct
+{
+    const ucunit_site_t * site; /* Site of the check */
+    unsigned char passed; /* 1 if the check passed, 0 if it failed */
+    unsigned char values; /* Number of captured values */
+    unsigned char type[UCUNIT_LOG_VALUES]; /* UCUNIT_VALUE_xxx */
+    ucunit_value_t value[UCUNIT_LOG_VALUES]; /* Captured values */
+} ucunit_event_t;
+#endif
+
+/* Statistics of a test run */
+typedef struct
+{
+    ucunit_counter_t checks_failed; /* Numer of failed checks */
+    ucunit_counter_t checks_passed; /* Number of passed checks */
+    ucunit_counter_t testcases_failed; /* Number of failed test cases */
+    ucunit_counter_t testcases_passed; /* Number of passed test cases */
+} ucunit_statistics_t;
+
+/* Progress of UCUNIT_RunTests() which survives a reset, see UCUNIT_PERSIST */
+typedef struct
+{
+    unsigned long magic; /* UCUNIT_PERSIST_MAGIC if the record is valid */
+    unsigned long suite; /* CRC32 of the filter and the number of tests */
+    ucunit_statistics_t statistics; /* Statistics of the finished tests */
+    int next; /* Index of the next test among the matching tests */
+    int running; /* TRUE while test next runs */
+    unsigned long timeout; /* Timeout of its testcase in ms, 0 if none */
+    unsigned long checksum; /* CRC32 of the members above */
+} ucunit_persist_t;
+
+#define UCUNIT_PERSIST_MAGIC 0x75435530UL
+
+/* Result of UCUNIT_RunProtected() if the testcase timeout expired */
+#define UCUNIT_SIGNAL_TIMEOUT (-1)
+
+/* Latencies between two tracepoints */
+typedef struct
+{
+    System_Ticks min; /* Shortest latency */
+    System_Ticks max; /* Longest latency */
+#ifdef UCUNIT_HAVE_INT64
+    unsigned long long sum; /* Sum of all latencies */
+#else
+    unsigned long sum; /* Sum of all latencies */
+#endif
+    unsigned long count; /* Number of latencies */
+} ucunit_latency_t;
+
+/* Statistics of a benchmark */
+typedef struct
+{
+    System_Ticks start; /* Tick counter at UCUNIT_BenchmarkBegin() */
+    System_Ticks overhead; /* Ticks of an empty measurement */
+    System_Ticks min; /* Shortest sample */
+    System_Ticks max; /* Longest sample */
+#ifdef UCUNIT_HAVE_INT64
+    unsigned long long sum; /* Sum of all samples */
+#else
+    unsigned long sum; /* Sum of all samples */
+#endif
+    unsigned long count; /* Number of samples */
+    int base; /* Bit length of the samples in the first histogram bin */
+    unsigned long histogram[UCUNIT_BENCHMARK_BINS];
+} ucunit_benchmark_t;
+
+#ifdef UCUNIT_SINKS
+/* Output sink. Specific sinks embed it as their first member. */
+typedef struct ucunit_sink_s ucunit_sink_t;
+struct ucunit_sink_s
+{
+    /* Writes length characters, they are not terminated */
+    void (*write)(ucunit_sink_t * sink, const char * buffer, int length);
+    void (*flush)(ucunit_sink_t * sink); /* Writes out buffered data */
+    void (*close)(ucunit_sink_t * sink); /* Ends the output */
+};
+
+/* Sink which stores the output in a RAM buffer, see UCUNIT_RamSinkInit() */
+typedef struct
+{
+    ucunit_sink_t sink;
+    char * buffer; /* Output, always terminated */
+    int size; /* Size of buffer */
+    int length; /* Number of stored characters */
+    unsigned long dropped; /* Number of characters that did not fit */
+} ucunit_ram_sink_t;
+
+/* Sink which writes to two sinks, see UCUNIT_TeeSinkInit() */
+typedef struct
+{
+    ucunit_sink_t sink;
+    ucunit_sink_t * first;
+    ucunit_sink_t * second;
+} ucunit_tee_sink_t;
+
+/* Sink which writes to a file descriptor of a hosted port, see
+   System_FdSinkInit() */
+typedef struct ucunit_fd_sink_s
+{
+    ucunit_sink_t sink;
+    int fd;
+} ucunit_fd_sink_t;
+#endif
+
+#ifdef UCUNIT_CAPTURE
+/* RAM capture buffer. The host finds it in a memory image by the
+   magic, the numbers are in the byte order of the target. */
+typedef struct
+{
+    char magic[8]; /* UCUNIT_CAPTURE_MAGIC */
+    ucunit_uint32_t size; /* UCUNIT_CAPTURE_SIZE */
+    ucunit_uint32_t length; /* Number of captured characters */
+    ucunit_uint32_t dropped; /* Number of characters that did not fit */
+    char data[UCUNIT_CAPTURE_SIZE]; /* Output, not terminated */
+} ucunit_capture_t;
+
+#define UCUNIT_CAPTURE_MAGIC "uCUCAPT" /* With the terminator 8 bytes */
+
+extern ucunit_capture_t ucunit_capture;
+#endif
+
+/* State of uCUnit. There is one instance for all files of a testsuite,
+   it is defined in uCUnit-v1.0.c. The members used by every check are
+   placed first, so they share one cache line and can be reached with
+   short offsets. Large and rarely used members follow. */
+typedef struct
+{
+    ucunit_statistics_t statistics; /* Statistics of the testsuite */
+    ucunit_counter_t checklist_failed_checks; /* Number of failed checks in a checklist */
+    ucunit_counter_t testcases_failed_checks; /* Number of failed checks in a testcase */
+    unsigned char failure_action; /* Action to take if a check fails */
+    System_Ticks testcase_start; /* Tick counter at begin of testcase */
+    System_Ticks testcase_deadline; /* Max. ticks of testcase, 0 if none */
+    ucunit_coverage_word_t coverage[UCUNIT_COVERAGE_WORDS]; /* One bit per tracepoint */
+#ifdef UCUNIT_TRACEPOINT_COUNTERS
+    ucunit_hits_t hits[UCUNIT_MAX_TRACEPOINTS]; /* Hit counter per tracepoint */
+#endif
+    ucunit_benchmark_t benchmark; /* Current benchmark */
+    unsigned long digest; /* CRC32 of UCUNIT_DigestUpdate() */
+#ifdef UCUNIT_CRASH_RECOVERY
+    const ucunit_site_t * last_site; /* Site of the last check, NULL if none */
+#endif
+#ifdef UCUNIT_TIMEOUTS
+    unsigned long testcase_timeout; /* Timeout of the following testcases in ms */
+    unsigned long timeout; /* Timeout of the running testcase in ms, 0 if none */
+#endif
+#ifdef UCUNIT_MODE_DEFERRED
+    int log_length; /* Number of records in the log */
+    unsigned long log_dropped; /* Number of records that did not fit */
+    ucunit_event_t * log_last; /* Last record, NULL if it was dropped */
+    ucunit_event_t log[UCUNIT_LOG_SIZE]; /* Deferred log */
+#endif
+#ifdef UCUNIT_TRACEPOINT_TIMESTAMPS
+    unsigned long trace_next; /* Number of entries ever written to the trace */
+    ucunit_trace_entry_t trace[UCUNIT_TRACE_BUFFER_SIZE]; /* Trace ring buffer */
+#endif
+#ifdef UCUNIT_SINKS
+    ucunit_sink_t * sink; /* Current sink, NULL for the default sink */
+    int sink_length; /* Number of characters in sink_buffer */
+    char sink_buffer[UCUNIT_SINK_BUFFER_SIZE]; /* Output of the current line */
+#endif
+} ucunit_state_t;
+
+extern ucunit_state_t ucunit_state;
+
+/* Names of the variables of earlier versions */
+#define ucunit_checks_failed ucunit_state.statistics.checks_failed
+#define ucunit_checks_passed ucunit_state.statistics.checks_passed
+#define ucunit_testcases_failed ucunit_state.statistics.testcases_failed
+#define ucunit_testcases_passed ucunit_state.statistics.testcases_passed
+#define ucunit_testcases_failed_checks ucunit_state.testcases_failed_checks
+#define ucunit_checklist_failed_checks ucunit_state.checklist_failed_checks
+#define ucunit_action ucunit_state.failure_action
+
+/*****************************************************************************/
+/* Output sinks */
+/*****************************************************************************/
+
+#ifdef UCUNIT_SINKS
+/* The framework writes to the current sink */
+#undef UCUNIT_WriteString
+#undef UCUNIT_WriteString_P
+#undef UCUNIT_WriteInt
+#undef UCUNIT_WriteByte
+#define UCUNIT_WriteString(msg)    UCUNIT_SinkWriteString(msg)
+#define UCUNIT_WriteString_P(msg)  UCUNIT_SinkWriteString_P(msg)
+#define UCUNIT_WriteInt(n)         UCUNIT_SinkWriteInt(n)
+#define UCUNIT_WriteByte(b)        UCUNIT_SinkWriteByte(b)
+
+/* Sink which writes with UCUNIT_WriteBuffer() */
+extern ucunit_sink_t ucunit_system_sink;
+
+/* Sink which writes to ucunit_capture, the default with UCUNIT_CAPTURE */
+#ifdef UCUNIT_CAPTURE
+extern ucunit_sink_t ucunit_capture_sink;
+#endif
+
+/**
+ * @Function:    UCUNIT_SinkWriteString(msg)
+ *
+ * @Description: Appends a string to the output buffer. The buffer is
+ *               written to the current sink at the end of each line
+ *               and when it is full.
+ *
+ * @Param msg:   String to write.
+ *
+ * @Remarks:     UCUNIT_SinkWriteString_P(msg), UCUNIT_SinkWriteInt(n)
+ *               and UCUNIT_SinkWriteByte(b) append in the same way.
+ *
+ */
+void UCUNIT_SinkWriteString(const char * msg);
+void UCUNIT_SinkWriteString_P(const char * msg);
+void UCUNIT_SinkWriteInt(int n);
+void UCUNIT_SinkWriteByte(unsigned char b);
+
+/**
+ * @Function:    UCUNIT_SetSink(sink)
+ *
+ * @Description: Flushes the output to the current sink and selects
+ *               another sink.
+ *
+ * @Param sink:  New sink, NULL for the default sink. This is the
+ *               system sink, with UCUNIT_CAPTURE the capture sink.
+ *
+ * @Return:      Previous sink.
+ *
+ */
+ucunit_sink_t * UCUNIT_SetSink(ucunit_sink_t * sink);
+
+/**
+ * @Function:    UCUNIT_FlushSink()
+ *
+ * @Description: Writes the output buffer to the current sink and
+ *               flushes the sink.
+ *
+ * @Remarks:     This is done by UCUNIT_WriteSummary(), after each
+ *               registered test and before a check stops the system.
+ *
+ */
+void UCUNIT_FlushSink(void);
+
+/**
+ * @Function:    UCUNIT_CloseSink()
+ *
+ * @Description: Flushes and closes the current sink and selects the
+ *               default sink.
+ *
+ */
+void UCUNIT_CloseSink(void);
+
+#ifdef UCUNIT_CAPTURE
+/**
+ * @Function:    UCUNIT_DumpCapture()
+ *
+ * @Description: Writes the RAM capture buffer to the host with one
+ *               call of UCUNIT_WriteBuffer(). If output was dropped,
+ *               the number of dropped characters follows.
+ *
+ * @Remarks:     This is only available with UCUNIT_CAPTURE. It is
+ *               called by System_Shutdown() and System_Safestate(),
+ *               unless UCUNIT_CAPTURE_NO_DUMP is defined.
+ *
+ */
+void UCUNIT_DumpCapture(void);
+#endif
+
+/**
+ * @Function:    UCUNIT_RamSinkInit(ram, buffer, size)
+ *
+ * @Description: Initializes a sink which stores the output in RAM.
+ *               The output is terminated, so it can be read as a
+ *               string with a debugger.
+ *
+ * @Param ram:   Sink to initialize.
+ * @Param buffer: Buffer for the output.
+ * @Param size:  Size of buffer, > 0. Output that does not fit is
+ *               counted in ram->dropped.
+ *
+ */
+void UCUNIT_RamSinkInit(ucunit_ram_sink_t * ram, char * buffer, int size);
+
+/**
+ * @Function:    UCUNIT_TeeSinkInit(tee, first, second)
+ *
+ * @Description: Initializes a sink which writes, flushes and closes
+ *               two other sinks, e.g. a RAM buffer and a slow link.
+ *
+ * @Param tee:   Sink to initialize.
+ * @Param first: First sink.
+ * @Param second: Second sink.
+ *
+ */
+void UCUNIT_TeeSinkInit(ucunit_tee_sink_t * tee, ucunit_sink_t * first,
+                        ucunit_sink_t * second);
+#else
+#define UCUNIT_FlushSink() do { } while(0)
+#endif
+
+#ifdef UCUNIT_REPORTERS
+/*****************************************************************************/
+/* Reporters */
+/*****************************************************************************/
+
+/**
+ * @Function:    UCUNIT_SetReporter(reporter, sink)
+ *
+ * @Description: Selects the reporter of the following testcases.
+ *               TAP writes "ok n - name # time=t.tttms" or "not ok",
+ *               followed by the output of the testcase as comments,
+ *               and the plan "1..n" with the summary. JUnit XML
+ *               writes a testcase element with the time in seconds,
+ *               the output of a failed testcase is the text of its
+ *               failure element. Failed checks outside of testcases
+ *               are reported as one more failed testcase.
+ *
+ * @Param reporter: UCUNIT_REPORTER_TEXT, UCUNIT_REPORTER_TAP or
+ *               UCUNIT_REPORTER_JUNIT.
+ * @Param sink:  Sink of the report, NULL for the current sink.
+ *
+ * @Remarks:     Passed checks are not reported. Output outside of
+ *               testcases, e.g. a banner, still goes to the current
+ *               sink, so give the JUnit reporter a sink of its own.
+ *
+ */
+void UCUNIT_SetReporter(int reporter, ucunit_sink_t * sink);
+
+/**
+ * @Function:    UCUNIT_ReportTestcaseBegin(name)
+ *
+ * @Description: Writes the header of a test case, or starts to
+ *               collect its output for the reporter.
+ *
+ * @Param name:  Name of the test case, it must stay valid until the
+ *               test case ends.
+ *
+ * @Remarks:     This function is used by UCUNIT_TestcaseBegin().
+ *
+ */
+void UCUNIT_ReportTestcaseBegin(const char * name);
+
+/**
+ * @Function:    UCUNIT_ReportTestcaseEnd(site)
+ *
+ * @Description: Writes the result of a test case.
+ *
+ * @Param site:  Site of UCUNIT_TestcaseEnd() if the test case failed,
+ *               NULL if it passed.
+ *
+ * @Remarks:     This function is used by UCUNIT_TestcaseEnd(), like
+ *               UCUNIT_ReportTestcaseSeparator(), which writes the
+ *               separator lines of the text records.
+ *
+ */
+void UCUNIT_ReportTestcaseEnd(const ucunit_site_t * site);
+void UCUNIT_ReportTestcaseSeparator(void);
+
+/**
+ * @Function:    UCUNIT_ReportSummary()
+ *
+ * @Description: Ends the report of the reporter.
+ *
+ * @Return:      FALSE for UCUNIT_REPORTER_TEXT, the caller writes the
+ *               text summary then.
+ *
+ * @Remarks:     This function is used by UCUNIT_WriteSummary().
+ *
+ */
+int UCUNIT_ReportSummary(void);
+#else
+#define UCUNIT_ReportSummary()    FALSE
+#endif
+
+/**
+ * @Function:    UCUNIT_GetStatistics(statistics)
+ *
+ * @Description: Copies the statistics of the testsuite.
+ *
+ * @Param statistics: Destination.
+ *
+ */
+void UCUNIT_GetStatistics(ucunit_statistics_t * statistics);
+
+/**
+ * @Function:    UCUNIT_MergeStatistics(statistics)
+ *
+ * @Description: Adds statistics to the statistics of the testsuite.
+ *
+ * @Param statistics: Statistics to add, e.g. the result of a part of
+ *               the testsuite that was run on another target or in
+ *               another process.
+ *
+ * @Remarks:     UCUNIT_WriteSummary() writes the total.
+ *
+ */
+void UCUNIT_MergeStatistics(const ucunit_statistics_t * statistics);
+
+/**
+ * @Function:    UCUNIT_WriteCounter(n)
+ *
+ * @Description: Writes a check or test case counter in decimal.
+ *
+ * @Param n:     Counter value.
+ *
+ * @Remarks:     This function is used by UCUNIT_WriteSummary(). It
+ *               handles all widths of UCUNIT_COUNTER_BITS.
+ *
+ */
+void UCUNIT_WriteCounter(ucunit_counter_t n);
+
+/**
+ * @Function:    UCUNIT_ResetStatistics()
+ *
+ * @Description: Sets all counters of the testsuite statistics to 0.
+ *
+ */
+void UCUNIT_ResetStatistics(void);
+
+/*****************************************************************************/
+/* Number formatting (uCUnit-v1.0.c)                                         */
+/*****************************************************************************/
+
+/**
+ * Division free formatting. If defined, decimal digits are computed by
+ * subtracting powers of ten instead of dividing by 100. Use this on
+ * cores without a hardware divider. This is the default for AVR.
+ */
+#if !defined(UCUNIT_FORMAT_NO_DIVIDE) && defined(__AVR__)
+#define UCUNIT_FORMAT_NO_DIVIDE
+#endif
+
+/* Size of a buffer for all UCUNIT_FormatXxx() functions:
+   sign, 20 decimal digits and the terminating 0 */
+#define UCUNIT_FORMAT_BUFFER_SIZE 24
+
+/**
+ * @Function:    UCUNIT_FormatU32(buffer, value)
+ *
+ * @Description: Converts an unsigned number into a decimal string.
+ *
+ * @Param buffer: Buffer of UCUNIT_FORMAT_BUFFER_SIZE characters.
+ * @Param value: Value to convert. Pass 8-bit and 16-bit values
+ *               here, too.
+ *
+ * @Return:      Length of the string without the terminating 0.
+ *
+ * @Remarks:     No printf() and no memory allocation is used. Wider
+ *               values are truncated to 32 bits, use UCUNIT_FormatU64()
+ *               for them.
+ *
+ */
+int UCUNIT_FormatU32(char * buffer, ucunit_uint32_t value);
+
+/**
+ * @Function:    UCUNIT_FormatS32(buffer, value)
+ *
+ * @Description: Converts a signed number into a decimal string.
+ *
+ * @Param buffer: Buffer of UCUNIT_FORMAT_BUFFER_SIZE characters.
+ * @Param value: Value to convert. Pass 8-bit and 16-bit values
+ *               here, too.
+ *
+ * @Return:      Length of the string without the terminating 0.
+ *
+ */
+int UCUNIT_FormatS32(char * buffer, ucunit_int32_t value);
+
+/**
+ * @Function:    UCUNIT_FormatHex32(buffer, value, digits)
+ *
+ * @Description: Converts a number into a hexadecimal string with
+ *               upper case digits and without prefix.
+ *
+ * @Param buffer: Buffer of UCUNIT_FORMAT_BUFFER_SIZE characters.
+ * @Param value: Value to convert.
+ * @Param digits: Minimum number of digits, e.g. 2, 4 or 8 for an
+ *               8-bit, 16-bit or 32-bit value. Leading digits are 0.
+ *
+ * @Return:      Length of the string without the terminating 0.
+ *
+ */
+int UCUNIT_FormatHex32(char * buffer, ucunit_uint32_t value, int digits);
+
+#ifdef UCUNIT_HAVE_INT64
+/**
+ * @Function:    UCUNIT_FormatU64(buffer, value)
+ *
+ * @Description: Converts an unsigned 64-bit number into a decimal string.
+ *
+ * @Param buffer: Buffer of UCUNIT_FORMAT_BUFFER_SIZE characters.
+ * @Param value: Value to convert.
+ *
+ * @Return:      Length of the string without the terminating 0.
+ *
+ * @Remarks:     Values that fit into 32-bit are passed to
+ *               UCUNIT_FormatU32(). The upper digits are computed
+ *               without 64-bit division.
+ *
+ */
+int UCUNIT_FormatU64(char * buffer, unsigned long long value);
+
+/**
+ * @Function:    UCUNIT_FormatS64(buffer, value)
+ *
+ * @Description: Converts a signed 64-bit number into a decimal string.
+ *
+ * @Param buffer: Buffer of UCUNIT_FORMAT_BUFFER_SIZE characters.
+ * @Param value: Value to convert.
+ *
+ * @Return:      Length of the string without the terminating 0.
+ *
+ */
+int UCUNIT_FormatS64(char * buffer, long long value);
+
+/**
+ * @Function:    UCUNIT_FormatHex64(buffer, value, digits)
+ *
+ * @Description: Converts a 64-bit number into a hexadecimal string.
+ *
+ * @Param buffer: Buffer of UCUNIT_FORMAT_BUFFER_SIZE characters.
+ * @Param value: Value to convert.
+ * @Param digits: Minimum number of digits.
+ *
+ * @Return:      Length of the string without the terminating 0.
+ *
+ */
+int UCUNIT_FormatHex64(char * buffer, unsigned long long value, int digits);
+#endif
+
+#ifndef UCUNIT_NO_FLOAT
+/**
+ * @Function:    UCUNIT_FormatDouble(buffer, value)
+ *
+ * @Description: Formats a floating point number with 7 significant
+ *               digits in exponential notation, e.g. "-1.234568e-03".
+ *
+ * @Param buffer: Buffer of UCUNIT_FORMAT_BUFFER_SIZE chars.
+ * @Param value:  Number to format.
+ *
+ * @Return:      Number of characters, without the terminating 0.
+ *
+ * @Remarks:     No printf() is used. The last digit may differ from
+ *               printf("%e") because the digits are computed with
+ *               floating point arithmetic.
+ *
+ */
+int UCUNIT_FormatDouble(char * buffer, double value);
+#endif
+
+/*****************************************************************************/
+/* Internal (private) Macros                                                 */
+/*****************************************************************************/
+
+/**
+ * @Macro:       UCUNIT_DefineToStringHelper(x)
+ *
+ * @Description: Helper macro for converting a define constant into
+ *               a string.
+ *
+ * @Param x:     Define value to convert.
+ *
+ * @Remarks:     This macro is used by UCUNIT_DefineToString().
+ *
+ */
+#define UCUNIT_DefineToStringHelper(x)    #x
+
+/**
+ * @Macro:       UCUNIT_DefineToString(x)
+ *
+ * @Description: Converts a define constant into a string.
+ *
+ * @Param x:     Define value to convert.
+ *
+ * @Remarks:     This macro uses UCUNIT_DefineToStringHelper().
+ *
+ */
+#define UCUNIT_DefineToString(x)   UCUNIT_DefineToStringHelper(x)
+
+#ifdef UCUNIT_MODE_TOKENIZED
+/**
+ * @Macro:       UCUNIT_WriteTokenU32(n)
+ *
+ * @Description: Writes a 32-bit number as 4 bytes, least significant
+ *               byte first.
+ *
+ * @Param n:     Number to write.
+ *
+ * @Remarks:     This macro is used in UCUNIT_MODE_TOKENIZED only.
+ *
+ */
+#define UCUNIT_WriteTokenU32(n)                                 \
+    do                                                          \
+    {                                                           \
+        UCUNIT_WriteByte((unsigned char)((n) & 0xFF));          \
+        UCUNIT_WriteByte((unsigned char)(((n) >> 8) & 0xFF));   \
+        UCUNIT_WriteByte((unsigned char)(((n) >> 16) & 0xFF));  \
+        UCUNIT_WriteByte((unsigned char)(((n) >> 24) & 0xFF));  \
+    } while(0)
+
+/**
+ * @Macro:       UCUNIT_WriteToken(tag)
+ *
+ * @Description: Writes a record for the current check site.
+ *
+ * @Param tag:   Record tag, one of UCUNIT_TOKEN_xxx.
+ *
+ * @Remarks:     The record is 4 bytes: tag, UCUNIT_FILE_ID and
+ *               __LINE__ (least significant byte first). The host
+ *               decoder looks up file ID and line in the site table.
+ *
+ */
+#define UCUNIT_WriteToken(tag)                                  \
+    do                                                          \
+    {                                                           \
+        UCUNIT_WriteByte(tag);                                  \
+        UCUNIT_WriteByte(UCUNIT_FILE_ID);                       \
+        UCUNIT_WriteByte((unsigned char)(__LINE__ & 0xFF));     \
+        UCUNIT_WriteByte((unsigned char)((__LINE__ >> 8) & 0xFF)); \
+    } while(0)
+
+/**
+ * @Macro:       UCUNIT_WriteTokenValue(n)
+ *
+ * @Description: Attaches a captured 32-bit value to the previous record.
+ *
+ * @Param n:     Value to write.
+ *
+ * @Remarks:     The decoder appends the value to the line of the
+ *               previous record.
+ *
+ */
+#define UCUNIT_WriteTokenValue(n)                               \
+    do                                                          \
+    {                                                           \
+        UCUNIT_WriteByte(UCUNIT_TOKEN_VALUE);                   \
+        UCUNIT_WriteTokenU32((unsigned long)(n));               \
+    } while(0)
+#endif
+
+/**
+ * @Macro:       UCUNIT_DefineSite(name, msg, args)
+ *
+ * @Description: Defines the static site descriptor of the current
+ *               check site.
+ *
+ * @Param name:  Name of the descriptor.
+ * @Param msg:   Message. This is the name of the called Check, without
+ *               the substring UCUNIT_Check.
+ * @Param args:  Argument list as string.
+ *
+ * @Remarks:     With UCUNIT_TEXT_SITES, msg and args may be strings in
+ *               variables, see UCUNIT_SiteOf(). Otherwise they must be
+ *               string literals. With UCUNIT_PROGMEM_STRINGS the texts
+ *               are in program memory.
+ *
+ */
+#ifdef UCUNIT_MODE_TOKENIZED
+#define UCUNIT_DefineSite(name, msg, args)                              \
+    static const ucunit_site_t name = { UCUNIT_FILE_ID, __LINE__ }
+#elif defined(UCUNIT_PROGMEM_STRINGS)
+#define UCUNIT_DefineSite(name, msg, args)                              \
+    static const char name##_file[] UCUNIT_PROGMEM = __FILE__;          \
+    static const char name##_msg[] UCUNIT_PROGMEM = msg;                \
+    static const char name##_args[] UCUNIT_PROGMEM = args;              \
+    static const ucunit_site_t name =                                   \
+        { name##_file, __LINE__, name##_msg, name##_args }
+#else
+#define UCUNIT_DefineSite(name, msg, args)                              \
+    static const ucunit_site_t name =                                   \
+        { __FILE__, __LINE__, UCUNIT_Literal(msg), UCUNIT_Literal(args) }
+#endif
+
+/* GCC tells string literals from other strings at compile time, so
+   UCUNIT_Check() takes a message in a variable in these modes, too.
+   Sites with literal texts stay static, the others are filled in at run
+   time. The texts of UCUNIT_PROGMEM_STRINGS are flash arrays and the
+   deferred log keeps site pointers until it is written, so both still
+   need literals. */
+#if defined(__GNUC__) && !defined(UCUNIT_MODE_TOKENIZED) &&             \
+    !defined(UCUNIT_MODE_DEFERRED) && !defined(UCUNIT_PROGMEM_STRINGS)
+#define UCUNIT_TEXT_SITES
+#endif
+
+#ifdef UCUNIT_TEXT_SITES
+#define UCUNIT_IsLiteral(s)    __builtin_constant_p(s)
+#define UCUNIT_Literal(s)                                               \
+    __builtin_choose_expr(UCUNIT_IsLiteral(s), (s), "")
+
+/**
+ * @Function:    UCUNIT_TextSite(file, line, msg, args)
+ *
+ * @Description: Fills in the site descriptor of a check whose texts
+ *               are not string literals.
+ *
+ * @Param file:  __FILE__ of the check.
+ * @Param line:  __LINE__ of the check.
+ * @Param msg:   Message.
+ * @Param args:  Argument list as string.
+ *
+ * @Return:      Pointer to the descriptor. It is shared by all such
+ *               checks and valid until the next one.
+ *
+ */
+const ucunit_site_t * UCUNIT_TextSite(const char * file, int line,
+                                      const char * msg, const char * args);
+
+/**
+ * @Macro:       UCUNIT_SiteOf(name, msg, args)
+ *
+ * @Description: Returns the site descriptor of the current check site.
+ *
+ * @Param name:  Name of the descriptor of UCUNIT_DefineSite().
+ * @Param msg:   Message.
+ * @Param args:  Argument list as string.
+ *
+ * @Remarks:     This is &name if msg and args are string literals,
+ *               else the descriptor of UCUNIT_TextSite().
+ *
+ */
+#define UCUNIT_SiteOf(name, msg, args)                                  \
+    __builtin_choose_expr(UCUNIT_IsLiteral(msg) && UCUNIT_IsLiteral(args), \
+                          &(name),                                      \
+                          UCUNIT_TextSite(__FILE__, __LINE__, msg, args))
+#else
+#define UCUNIT_Literal(s)    s
+#define UCUNIT_SiteOf(name, msg, args)    (&(name))
+#endif
+
+/**
+ * @Function:    UCUNIT_CheckSite(passed, site)
+ *
+ * @Description: Passes or fails a check. This is UCUNIT_PassCheck()
+ *               and UCUNIT_FailCheck() out of line.
+ *
+ * @Param passed: Result of the check, 0 if it failed.
+ * @Param site:   Site descriptor of the check.
+ *
+ * @Remarks:     This function is used by UCUNIT_Check() in
+ *               UCUNIT_MODE_COMPACT.
+ *
+ */
+void UCUNIT_CheckSite(int passed, const ucunit_site_t * site);
+
+/**
+ * @Function:    UCUNIT_CheckSiteValues(passed, site, type, a, b)
+ *
+ * @Description: Passes or fails a check and reports the two compared
+ *               values, e.g. "Testsuite.c:42: failed:IntEq(a,b) [1, 2]".
+ *
+ * @Param passed: Result of the check, 0 if it failed.
+ * @Param site:   Site descriptor of the check.
+ * @Param type:   Type of the values, one of UCUNIT_VALUE_xxx.
+ * @Param a:      First value.
+ * @Param b:      Second value.
+ *
+ * @Remarks:     This function is used by the typed comparison checks.
+ *
+ */
+void UCUNIT_CheckSiteValues(int passed, const ucunit_site_t * site, int type,
+                            ucunit_value_t a, ucunit_value_t b);
+
+/**
+ * @Function:    UCUNIT_WriteSite(passed, site)
+ *
+ * @Description: Writes the passed or failed message of a check site,
+ *               or appends it to the log in UCUNIT_MODE_DEFERRED.
+ *
+ * @Param passed: 1 for a passed message, 0 for a failed message.
+ * @Param site:   Site descriptor of the check.
+ *
+ */
+void UCUNIT_WriteSite(int passed, const ucunit_site_t * site);
+
+#ifdef UCUNIT_MODE_DEFERRED
+/**
+ * @Function:    UCUNIT_FlushLog()
+ *
+ * @Description: Writes all records of the deferred log in the format
+ *               of the immediate messages and empties the log.
+ *               Captured values are appended as " [v1, v2]".
+ *
+ * @Remarks:     The number of dropped records is written, too.
+ *
+ */
+void UCUNIT_FlushLog(void);
+
+/**
+ * @Macro:       UCUNIT_LogEvent(result, msg, args)
+ *
+ * @Description: Appends a record of the current check site to the
+ *               deferred log.
+ *
+ * @Param result: 1 if the check passed, 0 if it failed.
+ * @Param msg:   Message. This is the name of the called Check, without
+ *               the substring UCUNIT_Check.
+ * @Param args:  Argument list as string.
+ *
+ * @Remarks:     msg and args must be string literals. They are stored
+ *               with file and line in a static descriptor, the log
+ *               record only holds a pointer to it.
+ *
+ */
+#define UCUNIT_LogEvent(result, msg, args)                              \
+    do                                                                  \
+    {                                                                   \
+        UCUNIT_DefineSite(ucunit_site, msg, args);                      \
+        if (ucunit_state.log_length < UCUNIT_LOG_SIZE)                  \
+        {                                                               \
+            ucunit_event_t * ucunit_event =                             \
+                &ucunit_state.log[ucunit_state.log_length++];           \
+            ucunit_event->site = &ucunit_site;                          \
+            ucunit_event->passed = (result);                            \
+            ucunit_event->values = 0;                                   \
+            ucunit_state.log_last = ucunit_event;                       \
+        }                                                               \
+        else                                                            \
+        {                                                               \
+            ucunit_state.log_dropped++;                                 \
+            ucunit_state.log_last = NULL;                               \
+        }                                                               \
+    } while(0)
+
+/**
+ * @Macro:       UCUNIT_LogValue(n)
+ *
+ * @Description: Attaches a captured value to the last record of the
+ *               deferred log.
+ *
+ * @Param n:     Value to capture.
+ *
+ * @Remarks:     The value is ignored if the last record was dropped
+ *               or already holds UCUNIT_LOG_VALUES values.
+ *
+ */
+#define UCUNIT_LogValue(n)                                              \
+    do                                                                  \
+    {                                                                   \
+        ucunit_event_t * ucunit_event = ucunit_state.log_last;          \
+        if ((NULL != ucunit_event) && (ucunit_event->values < UCUNIT_LOG_VALUES)) \
+        {                                                               \
+            ucunit_event->type[ucunit_event->values] = UCUNIT_VALUE_INT; \
+            ucunit_event->value[ucunit_event->values++] = (ucunit_value_t)(long)(n); \
+        }                                                               \
+    } while(0)
+
+#define UCUNIT_FlushDeferred()    UCUNIT_FlushLog()
+#else
+#define UCUNIT_FlushDeferred()
+#endif
+
+#ifdef UCUNIT_MODE_VERBOSE
+#if defined(UCUNIT_MODE_COMPACT) || defined(UCUNIT_REPORTERS)
+#define UCUNIT_WritePassedMsg(msg, args)                        \
+    do                                                          \
+    {                                                           \
+        UCUNIT_DefineSite(ucunit_site, msg, args);              \
+        UCUNIT_WriteSite(1, UCUNIT_SiteOf(ucunit_site, msg, args)); \
+    } while(0)
+#elif defined(UCUNIT_MODE_TOKENIZED)
+#define UCUNIT_WritePassedMsg(msg, args) UCUNIT_WriteToken(UCUNIT_TOKEN_PASSED)
+#elif defined(UCUNIT_MODE_DEFERRED)
+#define UCUNIT_WritePassedMsg(msg, args) UCUNIT_LogEvent(1, msg, args)
+#else
+/**
+ * @Macro:       UCUNIT_WritePassedMsg(msg, args)
+ *
+ * @Description: Writes a message that check has passed.
+ *
+ * @Param msg:   Message to write. This is the name of the called
+ *               Check, without the substring UCUNIT_Check.
+ * @Param args:  Argument list as string.
+ *
+ * @Remarks:     This macro is used by UCUNIT_Check(). A message will
+ *               only be written if verbose mode is set
+ *               to UCUNIT_MODE_VERBOSE.
+ *               With UCUNIT_PROGMEM_STRINGS the message is one string
+ *               in flash, so msg and args must be string literals.
+ *
+ */
+#ifdef UCUNIT_PROGMEM_STRINGS
+#define UCUNIT_WritePassedMsg(msg, args)                        \
+    do                                                          \
+    {                                                           \
+        UCUNIT_WriteString_P(UCUNIT_PSTR(__FILE__ ":"           \
+                             UCUNIT_DefineToString(__LINE__)    \
+                             ": passed:" msg "(" args ")\n"));  \
+    } while(0)
+#else
+#define UCUNIT_WritePassedMsg(msg, args)                        \
+    do                                                          \
+    {                                                           \
+        UCUNIT_WriteString(__FILE__);                           \
+        UCUNIT_WriteString(":");                                \
+        UCUNIT_WriteString(UCUNIT_DefineToString(__LINE__));    \
+        UCUNIT_WriteString(": passed:");                        \
+        UCUNIT_WriteString(msg);                                \
+        UCUNIT_WriteString("(");                                \
+        UCUNIT_WriteString(args);                               \
+        UCUNIT_WriteString(")\n");                              \
+    } while(0)
+#endif
+#endif
+#else
+#define UCUNIT_WritePassedMsg(msg, args)
+#endif
+
+#ifdef UCUNIT_MODE_SILENT
+#define UCUNIT_WriteFailedMsg(msg, args)
+#elif defined(UCUNIT_MODE_COMPACT) || defined(UCUNIT_REPORTERS)
+#define UCUNIT_WriteFailedMsg(msg, args)                        \
+    do                                                          \
+    {                                                           \
+        UCUNIT_DefineSite(ucunit_site, msg, args);              \
+        UCUNIT_WriteSite(0, UCUNIT_SiteOf(ucunit_site, msg, args)); \
+    } while(0)
+#elif defined(UCUNIT_MODE_TOKENIZED)
+#define UCUNIT_WriteFailedMsg(msg, args) UCUNIT_WriteToken(UCUNIT_TOKEN_FAILED)
+#elif defined(UCUNIT_MODE_DEFERRED)
+#define UCUNIT_WriteFailedMsg(msg, args) UCUNIT_LogEvent(0, msg, args)
+#else
+/**
+ * @Macro:       UCUNIT_WriteFailedMsg(msg, args)
+ *
+ * @Description: Writes a message that check has failed.
+ *
+ * @Param msg:   Message to write. This is the name of the called
+ *               Check, without the substring UCUNIT_Check.
+ * @Param args:  Argument list as string.
+ *
+ * @Remarks:     This macro is used by UCUNIT_Check(). A message will
+ *               only be written if verbose mode is set
+ *               to UCUNIT_MODE_NORMAL and UCUNIT_MODE_VERBOSE.
+ *               With UCUNIT_PROGMEM_STRINGS the message is one string
+ *               in flash, so msg and args must be string literals.
+ *
+ */
+#ifdef UCUNIT_PROGMEM_STRINGS
+#define UCUNIT_WriteFailedMsg(msg, args)                        \
+    do                                                          \
+    {                                                           \
+        UCUNIT_WriteString_P(UCUNIT_PSTR(__FILE__ ":"           \
+                             UCUNIT_DefineToString(__LINE__)    \
+                             ": failed:" msg "(" args ")\n"));  \
+    } while(0)
+#else
+#define UCUNIT_WriteFailedMsg(msg, args)                        \
+    do                                                          \
+    {                                                           \
+        UCUNIT_WriteString(__FILE__);                           \
+        UCUNIT_WriteString(":");                                \
+        UCUNIT_WriteString(UCUNIT_DefineToString(__LINE__));    \
+        UCUNIT_WriteString(": failed:");                        \
+        UCUNIT_WriteString(msg);                                \
+        UCUNIT_WriteString("(");                                \
+        UCUNIT_WriteString(args);                               \
+        UCUNIT_WriteString(")\n");                              \
+    } while(0)
+#endif
+#endif
+
+/**
+ * @Macro:       UCUNIT_FailCheck(msg, args)
+ *
+ * @Description: Fails a check.
+ *
+ * @Param msg:   Message to write. This is the name of the called
+ *               Check, without the substring UCUNIT_Check.
+ * @Param args:  Argument list as string.
+ *
+ * @Remarks:     This macro is used by UCUNIT_Check(). A message will
+ *               only be written if verbose mode is set
+ *               to UCUNIT_MODE_NORMAL and UCUNIT_MODE_VERBOSE.
+ *
+ */
+#define UCUNIT_FailCheck(msg, args)                  \
+    do                                               \
+    {                                                \
+        if (UCUNIT_ACTION_SAFESTATE==ucunit_state.failure_action) \
+        {                                            \
+            UCUNIT_FlushSink();                      \
+            UCUNIT_Safestate();                      \
+        }                                            \
+        UCUNIT_WriteFailedMsg(msg, args);            \
+        ucunit_state.statistics.checks_failed++;     \
+        ucunit_state.checklist_failed_checks++;      \
+    } while(0)
+
+/**
+ * @Macro:       UCUNIT_PassCheck(msg, args)
+ *
+ * @Description: Passes a check.
+ *
+ * @Param msg:   Message to write. This is the name of the called
+ *               Check, without the substring UCUNIT_Check.
+ * @Param args:  Argument list as string.
+ *
+ * @Remarks:     This macro is used by UCUNIT_Check(). A message will
+ *               only be written if verbose mode is set
+ *               to UCUNIT_MODE_VERBOSE.
+ *
+ */
+#define UCUNIT_PassCheck(message, args)              \
+    do                                               \
+    {                                                \
+        UCUNIT_WritePassedMsg(message, args);        \
+        ucunit_state.statistics.checks_passed++;     \
+    } while(0)
+
+/*****************************************************************************/
+/* Checklist Macros                                                          */
+/*****************************************************************************/
+
+/**
+ * @Macro:       UCUNIT_ChecklistBegin(action)
+ *
+ * @Description: Begin of a checklist. You have to tell what action
+ *               shall be taken if a check fails.
+ *
+ * @Param action: Action to take. This can be:
+ *                * UCUNIT_ACTION_WARNING:   A warning message will be printed
+ *                                           that a check has failed
+ *                * UCUNIT_ACTION_SHUTDOWN:  The system will shutdown at
+ *                                           the end of the checklist.
+ *                * UCUNIT_ACTION_SAFESTATE: The system goes into the safe state
+ *                                           on the first failed check.
+
+ * @Remarks:     A checklist must be finished with UCUNIT_ChecklistEnd()
+ *
+ */
+#define UCUNIT_ChecklistBegin(action)                           \
+    do                                                          \
+    {                                                           \
+        ucunit_state.failure_action = action;                   \
+        ucunit_state.checklist_failed_checks = 0;               \
+    } while (0)
+
+/**
+ * @Macro:       UCUNIT_ChecklistEnd()
+ *
+ * @Description: End of a checklist. If the action was UCUNIT_ACTION_SHUTDOWN
+ *               the system will shutdown.
+ *
+ * @Remarks:     A checklist must begin with UCUNIT_ChecklistBegin(action)
+ *
+ */
+#define UCUNIT_ChecklistEnd()                         \
+    if (ucunit_state.checklist_failed_checks!=0)      \
+    {                                                 \
+        UCUNIT_WriteFailedMsg("Checklist","");        \
+        UCUNIT_FlushDeferred();                       \
+        if (UCUNIT_ACTION_SHUTDOWN==ucunit_state.failure_action) \
+        {                                             \
+            UCUNIT_FlushSink();                       \
+            UCUNIT_Shutdown();                        \
+        }                                             \
+    }                                                 \
+    else                                              \
+    {                                                 \
+        UCUNIT_WritePassedMsg("Checklist","");        \
+        UCUNIT_FlushDeferred();                       \
+    }
+
+/*****************************************************************************/
+/* Check Macros                                                              */
+/*****************************************************************************/
+
+/**
+ * @Macro:       UCUNIT_Check(condition, msg, args)
+ *
+ * @Description: Checks a condition and prints a message.
+ *
+ * @Param msg:   Message to write.
+ * @Param args:  Argument list as string
+ *
+ * @Remarks:     Basic check. This macro is used by all higher level checks.
+ *               In UCUNIT_MODE_COMPACT it calls UCUNIT_CheckSite().
+ *               With UCUNIT_CRASH_RECOVERY it records its site.
+ *
+ */
+#ifdef UCUNIT_MODE_COMPACT
+#define UCUNIT_Check(condition, msg, args)             \
+    do                                                 \
+    {                                                  \
+        UCUNIT_DefineSite(ucunit_site, msg, args);     \
+        UCUNIT_CheckSite( (condition) ? 1 : 0,         \
+                          UCUNIT_SiteOf(ucunit_site, msg, args) ); \
+    } while(0)
+#elif defined(UCUNIT_CRASH_RECOVERY)
+#define UCUNIT_Check(condition, msg, args)             \
+    do                                                 \
+    {                                                  \
+        UCUNIT_DefineSite(ucunit_site, msg, args);     \
+        if ( (condition) ) { UCUNIT_PassCheck(msg, args); } else { UCUNIT_FailCheck(msg, args); } \
+        ucunit_state.last_site = UCUNIT_SiteOf(ucunit_site, msg, args); \
+    } while(0)
+#else
+#define UCUNIT_Check(condition, msg, args)             \
+    if ( (condition) ) { UCUNIT_PassCheck(msg, args); } else { UCUNIT_FailCheck(msg, args); }
+#endif
+
+/**
+ * @Macro:       UCUNIT_CheckIsEqual(expected,actual)
+ *
+ * @Description: Checks that actual value equals the expected value.
+ *
+ * @Param expected: Expected value.
+ * @Param actual: Actual value.
+ *
+ * @Remarks:     This macro uses UCUNIT_Check(condition, msg, args).
+ *
+ */
+#define UCUNIT_CheckIsEqual(expected,actual)         \
+    UCUNIT_Check( (expected) == (actual), "IsEqual", #expected "," #actual )
+
+/**
+ * @Macro:       UCUNIT_CheckIsNull(pointer)
+ *
+ * @Description: Checks that a pointer is NULL.
+ *
+ * @Param pointer: Pointer to check.
+ *
+ * @Remarks:     This macro uses UCUNIT_Check(condition, msg, args).
+ *
+ */
+#define UCUNIT_CheckIsNull(pointer)                  \
+    UCUNIT_Check( (pointer) == NULL, "IsNull", #pointer)
+
+/**
+ * @Macro:       UCUNIT_CheckIsNotNull(pointer)
+ *
+ * @Description: Checks that a pointer is not NULL.
+ *
+ * @Param pointer: Pointer to check.
+ *
+ * @Remarks:     This macro uses UCUNIT_Check(condition, msg, args).
+ *
+ */
+#define UCUNIT_CheckIsNotNull(pointer)               \
+    UCUNIT_Check( (pointer) != NULL, "IsNotNull", #pointer)
 
 /**
  * @Macro:       UCUNIT_CheckIsInRange(value, lower, upper)
  *
- * @Description: Checks if a value is between lower and upper bounds (inclusive)
- *               Mathematical: lower <= value <= upper
+ * @Description: Checks if a value is between lower and upper bounds (inclusive)
+ *               Mathematical: lower <= value <= upper
+ *
+ * @Param value: Value to check.
+ * @Param lower: Lower bound.
+ * @Param upper: Upper bound.
+ *
+ * @Remarks:     This macro uses UCUNIT_Check(condition, msg, args).
+ *
+ */
+#define UCUNIT_CheckIsInRange(value, lower, upper)   \
+    UCUNIT_Check( ( (value>=lower) && (value<=upper) ), "IsInRange", #value "," #lower "," #upper)
+
+/**
+ * @Macro:       UCUNIT_CheckIs8Bit(value)
+ *
+ * @Description: Checks if a value fits into 8-bit.
+ *
+ * @Param value: Value to check.
+ *
+ * @Remarks:     This macro uses UCUNIT_Check(condition, msg, args).
+ *
+ */
+#define UCUNIT_CheckIs8Bit(value)                      \
+    UCUNIT_Check( value==(value & 0xFF), "Is8Bit", #value )
+
+/**
+ * @Macro:       UCUNIT_CheckIs16Bit(value)
+ *
+ * @Description: Checks if a value fits into 16-bit.
+ *
+ * @Param value: Value to check.
+ *
+ * @Remarks:     This macro uses UCUNIT_Check(condition, msg, args).
+ *
+ */
+#define UCUNIT_CheckIs16Bit(value)                     \
+    UCUNIT_Check( value==(value & 0xFFFF), "Is16Bit", #value )
+
+/**
+ * @Macro:       UCUNIT_CheckIs32Bit(value)
+ *
+ * @Description: Checks if a value fits into 32-bit.
+ *
+ * @Param value: Value to check.
+ *
+ * @Remarks:     This macro uses UCUNIT_Check(condition, msg, args).
+ *
+ */
+#define UCUNIT_CheckIs32Bit(value)                     \
+    UCUNIT_Check( value==(value & 0xFFFFFFFF), "Is32Bit", #value )
+
+/**
+ * Checks if bit is set
+ */
+/**
+ * @Macro:       UCUNIT_CheckIsBitSet(value, bitno)
+ *
+ * @Description: Checks if a bit is set in value.
+ *
+ * @Param value: Value to check.
+ * @Param bitno: Bit number. The least significant bit is 0.
+ *
+ * @Remarks:     This macro uses UCUNIT_Check(condition, msg, args).
+ *
+ */
+#define UCUNIT_CheckIsBitSet(value, bitno) \
+    UCUNIT_Check( (1==(((value)>>(bitno)) & 0x01) ), "IsBitSet", #value "," #bitno)
+
+/**
+ * @Macro:       UCUNIT_CheckIsBitClear(value, bitno)
+ *
+ * @Description: Checks if a bit is not set in value.
+ *
+ * @Param value: Value to check.
+ * @Param bitno: Bit number. The least significant bit is 0.
+ *
+ * @Remarks:     This macro uses UCUNIT_Check(condition, msg, args).
+ *
+ */
+#define UCUNIT_CheckIsBitClear(value, bitno) \
+    UCUNIT_Check( (0==(((value)>>(bitno)) & 0x01) ), "IsBitClear", #value "," #bitno)
+
+/*****************************************************************************/
+/* Typed Comparison Checks                                                   */
+/*****************************************************************************/
+
+/**
+ * @Macro:       UCUNIT_CheckCompare(type, value_type, conv, a, op, b, msg, args)
+ *
+ * @Description: Evaluates a and b exactly once into temporaries of
+ *               type, compares them with op and reports both values.
+ *
+ * @Param type:       C type of the temporaries.
+ * @Param value_type: Type of the reported values, UCUNIT_VALUE_xxx.
+ * @Param conv:       Cast of a temporary to ucunit_value_t.
+ * @Param a:          First operand.
+ * @Param op:         Comparison operator.
+ * @Param b:          Second operand.
+ * @Param msg:        Name of the check.
+ * @Param args:       Argument list as string.
+ *
+ * @Remarks:     This macro is used by all typed comparison checks.
+ *               The values are written after the message, e.g.
+ *               "failed:IntEq(x,y) [1, 2]".
+ *
+ */
+#define UCUNIT_CheckCompare(type, value_type, conv, a, op, b, msg, args) \
+    do                                                                  \
+    {                                                                   \
+        UCUNIT_DefineSite(ucunit_site, msg, args);                      \
+        type ucunit_a = (a);                                            \
+        type ucunit_b = (b);                                            \
+        UCUNIT_CheckSiteValues( (ucunit_a op ucunit_b) ? 1 : 0, &ucunit_site, \
+                                value_type, conv ucunit_a, conv ucunit_b ); \
+    } while(0)
+
+/**
+ * @Macro:       UCUNIT_CheckIntEq(a, b) ... UCUNIT_CheckIntGe(a, b)
+ *
+ * @Description: Checks a == b, a != b, a < b, a <= b, a > b and a >= b
+ *               of signed integers up to 32 bit.
+ *
+ * @Param a:     First operand, evaluated once.
+ * @Param b:     Second operand, evaluated once.
+ *
+ * @Remarks:     The operands are converted to ucunit_int32_t. Use
+ *               UCUNIT_CheckInt64Xx() for wider values.
+ *
+ */
+#define UCUNIT_CheckIntEq(a, b) \
+    UCUNIT_CheckCompare(ucunit_int32_t, UCUNIT_VALUE_INT, (ucunit_value_t), a, ==, b, "IntEq", #a "," #b)
+#define UCUNIT_CheckIntNe(a, b) \
+    UCUNIT_CheckCompare(ucunit_int32_t, UCUNIT_VALUE_INT, (ucunit_value_t), a, !=, b, "IntNe", #a "," #b)
+#define UCUNIT_CheckIntLt(a, b) \
+    UCUNIT_CheckCompare(ucunit_int32_t, UCUNIT_VALUE_INT, (ucunit_value_t), a, <, b, "IntLt", #a "," #b)
+#define UCUNIT_CheckIntLe(a, b) \
+    UCUNIT_CheckCompare(ucunit_int32_t, UCUNIT_VALUE_INT, (ucunit_value_t), a, <=, b, "IntLe", #a "," #b)
+#define UCUNIT_CheckIntGt(a, b) \
+    UCUNIT_CheckCompare(ucunit_int32_t, UCUNIT_VALUE_INT, (ucunit_value_t), a, >, b, "IntGt", #a "," #b)
+#define UCUNIT_CheckIntGe(a, b) \
+    UCUNIT_CheckCompare(ucunit_int32_t, UCUNIT_VALUE_INT, (ucunit_value_t), a, >=, b, "IntGe", #a "," #b)
+
+/**
+ * @Macro:       UCUNIT_CheckUIntEq(a, b) ... UCUNIT_CheckUIntGe(a, b)
+ *
+ * @Description: Same as UCUNIT_CheckIntXx() for unsigned integers up
+ *               to 32 bit.
+ *
+ * @Param a:     First operand, evaluated once.
+ * @Param b:     Second operand, evaluated once.
+ *
+ * @Remarks:     The operands are converted to ucunit_uint32_t. Use
+ *               UCUNIT_CheckUInt64Xx() for wider values.
+ *
+ */
+#define UCUNIT_CheckUIntEq(a, b) \
+    UCUNIT_CheckCompare(ucunit_uint32_t, UCUNIT_VALUE_UINT, (ucunit_value_t), a, ==, b, "UIntEq", #a "," #b)
+#define UCUNIT_CheckUIntNe(a, b) \
+    UCUNIT_CheckCompare(ucunit_uint32_t, UCUNIT_VALUE_UINT, (ucunit_value_t), a, !=, b, "UIntNe", #a "," #b)
+#define UCUNIT_CheckUIntLt(a, b) \
+    UCUNIT_CheckCompare(ucunit_uint32_t, UCUNIT_VALUE_UINT, (ucunit_value_t), a, <, b, "UIntLt", #a "," #b)
+#define UCUNIT_CheckUIntLe(a, b) \
+    UCUNIT_CheckCompare(ucunit_uint32_t, UCUNIT_VALUE_UINT, (ucunit_value_t), a, <=, b, "UIntLe", #a "," #b)
+#define UCUNIT_CheckUIntGt(a, b) \
+    UCUNIT_CheckCompare(ucunit_uint32_t, UCUNIT_VALUE_UINT, (ucunit_value_t), a, >, b, "UIntGt", #a "," #b)
+#define UCUNIT_CheckUIntGe(a, b) \
+    UCUNIT_CheckCompare(ucunit_uint32_t, UCUNIT_VALUE_UINT, (ucunit_value_t), a, >=, b, "UIntGe", #a "," #b)
+
+/**
+ * @Macro:       UCUNIT_CheckPtrEq(a, b) ... UCUNIT_CheckPtrGe(a, b)
+ *
+ * @Description: Same as UCUNIT_CheckIntXx() for pointers. The values
+ *               are written in hex.
+ *
+ * @Param a:     First pointer, evaluated once.
+ * @Param b:     Second pointer, evaluated once.
+ *
+ */
+#define UCUNIT_CheckPtrEq(a, b) \
+    UCUNIT_CheckCompare(const void *, UCUNIT_VALUE_PTR, (ucunit_value_t)(size_t), a, ==, b, "PtrEq", #a "," #b)
+#define UCUNIT_CheckPtrNe(a, b) \
+    UCUNIT_CheckCompare(const void *, UCUNIT_VALUE_PTR, (ucunit_value_t)(size_t), a, !=, b, "PtrNe", #a "," #b)
+#define UCUNIT_CheckPtrLt(a, b) \
+    UCUNIT_CheckCompare(const void *, UCUNIT_VALUE_PTR, (ucunit_value_t)(size_t), a, <, b, "PtrLt", #a "," #b)
+#define UCUNIT_CheckPtrLe(a, b) \
+    UCUNIT_CheckCompare(const void *, UCUNIT_VALUE_PTR, (ucunit_value_t)(size_t), a, <=, b, "PtrLe", #a "," #b)
+#define UCUNIT_CheckPtrGt(a, b) \
+    UCUNIT_CheckCompare(const void *, UCUNIT_VALUE_PTR, (ucunit_value_t)(size_t), a, >, b, "PtrGt", #a "," #b)
+#define UCUNIT_CheckPtrGe(a, b) \
+    UCUNIT_CheckCompare(const void *, UCUNIT_VALUE_PTR, (ucunit_value_t)(size_t), a, >=, b, "PtrGe", #a "," #b)
+
+#ifdef UCUNIT_HAVE_INT64
+/**
+ * @Macro:       UCUNIT_CheckInt64Eq(a, b) ... UCUNIT_CheckUInt64Ge(a, b)
+ *
+ * @Description: Same as UCUNIT_CheckIntXx() and UCUNIT_CheckUIntXx()
+ *               for 64-bit integers.
+ *
+ * @Param a:     First operand, evaluated once.
+ * @Param b:     Second operand, evaluated once.
+ *
+ * @Remarks:     Not available with UCUNIT_NO_INT64.
+ *
+ */
+#define UCUNIT_CheckInt64Eq(a, b) \
+    UCUNIT_CheckCompare(long long, UCUNIT_VALUE_INT64, (ucunit_value_t), a, ==, b, "Int64Eq", #a "," #b)
+#define UCUNIT_CheckInt64Ne(a, b) \
+    UCUNIT_CheckCompare(long long, UCUNIT_VALUE_INT64, (ucunit_value_t), a, !=, b, "Int64Ne", #a "," #b)
+#define UCUNIT_CheckInt64Lt(a, b) \
+    UCUNIT_CheckCompare(long long, UCUNIT_VALUE_INT64, (ucunit_value_t), a, <, b, "Int64Lt", #a "," #b)
+#define UCUNIT_CheckInt64Le(a, b) \
+    UCUNIT_CheckCompare(long long, UCUNIT_VALUE_INT64, (ucunit_value_t), a, <=, b, "Int64Le", #a "," #b)
+#define UCUNIT_CheckInt64Gt(a, b) \
+    UCUNIT_CheckCompare(long long, UCUNIT_VALUE_INT64, (ucunit_value_t), a, >, b, "Int64Gt", #a "," #b)
+#define UCUNIT_CheckInt64Ge(a, b) \
+    UCUNIT_CheckCompare(long long, UCUNIT_VALUE_INT64, (ucunit_value_t), a, >=, b, "Int64Ge", #a "," #b)
+
+#define UCUNIT_CheckUInt64Eq(a, b) \
+    UCUNIT_CheckCompare(unsigned long long, UCUNIT_VALUE_UINT64, (ucunit_value_t), a, ==, b, "UInt64Eq", #a "," #b)
+#define UCUNIT_CheckUInt64Ne(a, b) \
+    UCUNIT_CheckCompare(unsigned long long, UCUNIT_VALUE_UINT64, (ucunit_value_t), a, !=, b, "UInt64Ne", #a "," #b)
+#define UCUNIT_CheckUInt64Lt(a, b) \
+    UCUNIT_CheckCompare(unsigned long long, UCUNIT_VALUE_UINT64, (ucunit_value_t), a, <, b, "UInt64Lt", #a "," #b)
+#define UCUNIT_CheckUInt64Le(a, b) \
+    UCUNIT_CheckCompare(unsigned long long, UCUNIT_VALUE_UINT64, (ucunit_value_t), a, <=, b, "UInt64Le", #a "," #b)
+#define UCUNIT_CheckUInt64Gt(a, b) \
+    UCUNIT_CheckCompare(unsigned long long, UCUNIT_VALUE_UINT64, (ucunit_value_t), a, >, b, "UInt64Gt", #a "," #b)
+#define UCUNIT_CheckUInt64Ge(a, b) \
+    UCUNIT_CheckCompare(unsigned long long, UCUNIT_VALUE_UINT64, (ucunit_value_t), a, >=, b, "UInt64Ge", #a "," #b)
+#endif
+
+/*****************************************************************************/
+/* Memory Checks                                                             */
+/*****************************************************************************/
+
+/**
+ * @Function:    UCUNIT_MemCompare(a, b, len)
+ *
+ * @Description: Compares two memory blocks.
+ *
+ * @Param a:     First block.
+ * @Param b:     Second block.
+ * @Param len:   Number of bytes.
+ *
+ * @Return:      Offset of the first differing byte, len if equal.
+ *
+ * @Remarks:     Compares a word, or 16 bytes with SSE2, at a time.
+ *
+ */
+size_t UCUNIT_MemCompare(const void * a, const void * b, size_t len);
+
+/**
+ * @Function:    UCUNIT_MemCompareFill(buf, byte, len)
+ *
+ * @Description: Compares a memory block with a fill byte.
+ *
+ * @Param buf:   Block.
+ * @Param byte:  Fill byte.
+ * @Param len:   Number of bytes.
+ *
+ * @Return:      Offset of the first other byte, len if all are equal.
+ *
+ */
+size_t UCUNIT_MemCompareFill(const void * buf, unsigned char byte, size_t len);
+
+/**
+ * @Function:    UCUNIT_CheckMemSite(site, expected, fill, actual, len)
+ *
+ * @Description: Passes or fails a memory check. A failed check reports
+ *               the offset of the first difference and writes
+ *               UCUNIT_MEM_WINDOW bytes of both blocks around it.
+ *
+ * @Param site:     Site descriptor of the check.
+ * @Param expected: Expected block, NULL to compare with fill.
+ * @Param fill:     Expected fill byte if expected is NULL.
+ * @Param actual:   Actual block.
+ * @Param len:      Number of bytes.
+ *
+ * @Remarks:     This function is used by UCUNIT_CheckMemEqual() and
+ *               UCUNIT_CheckMemFill(). In UCUNIT_MODE_DEFERRED only
+ *               the offset is logged.
+ *
+ */
+void UCUNIT_CheckMemSite(const ucunit_site_t * site, const void * expected,
+                         unsigned char fill, const void * actual, size_t len);
+
+/**
+ * @Macro:       UCUNIT_CheckMemEqual(expected, actual, len)
+ *
+ * @Description: Checks if two memory blocks are equal. This counts as
+ *               one check.
+ *
+ * @Param expected: Expected block.
+ * @Param actual:   Actual block.
+ * @Param len:      Number of bytes.
+ *
+ */
+#define UCUNIT_CheckMemEqual(expected, actual, len)                     \
+    do                                                                  \
+    {                                                                   \
+        UCUNIT_DefineSite(ucunit_site, "MemEqual",                      \
+                          #expected "," #actual "," #len);              \
+        UCUNIT_CheckMemSite(&ucunit_site, (expected), 0, (actual), (len)); \
+    } while(0)
+
+/**
+ * @Macro:       UCUNIT_CheckMemFill(buf, byte, len)
+ *
+ * @Description: Checks if all bytes of a memory block are equal to
+ *               byte. This counts as one check.
+ *
+ * @Param buf:   Block.
+ * @Param byte:  Fill byte.
+ * @Param len:   Number of bytes.
+ *
+ */
+#define UCUNIT_CheckMemFill(buf, byte, len)                             \
+    do                                                                  \
+    {                                                                   \
+        UCUNIT_DefineSite(ucunit_site, "MemFill",                       \
+                          #buf "," #byte "," #len);                     \
+        UCUNIT_CheckMemSite(&ucunit_site, NULL, (unsigned char)(byte),  \
+                            (buf), (len));                              \
+    } while(0)
+
+/*****************************************************************************/
+/* CRC Checks                                                                */
+/*****************************************************************************/
+
+/**
+ * Small CRC32 kernel. If defined, the CRC32 is computed a nibble at a
+ * time with a table of 16 words in flash. Otherwise it is computed
+ * 8 bytes at a time (slicing-by-8) with 8 tables of 256 words, which
+ * are built in RAM on first use. This is the default for AVR.
+ */
+#if !defined(UCUNIT_CRC32_SMALL) && defined(__AVR__)
+#define UCUNIT_CRC32_SMALL
+#endif
+
+/**
+ * @Function:    UCUNIT_Crc32Update(crc, data, len)
+ *
+ * @Description: Continues the CRC32 (IEEE 802.3, as zlib) of a
+ *               data stream.
+ *
+ * @Param crc:   CRC32 of the data so far, 0 for the first block.
+ * @Param data:  Next block.
+ * @Param len:   Number of bytes.
+ *
+ * @Return:      CRC32 of the data including this block.
+ *
+ */
+unsigned long UCUNIT_Crc32Update(unsigned long crc, const void * data, size_t len);
+
+/**
+ * @Macro:       UCUNIT_Crc32(data, len)
+ *
+ * @Description: Returns the CRC32 of a memory block.
+ *
+ * @Param data:  Block.
+ * @Param len:   Number of bytes.
+ *
+ */
+#define UCUNIT_Crc32(data, len)    UCUNIT_Crc32Update(0, (data), (len))
+
+/**
+ * @Macro:       UCUNIT_CheckCrc32Equal(buf, len, expected_crc)
+ *
+ * @Description: Checks the CRC32 of a memory block. Both CRCs are
+ *               reported in hex.
+ *
+ * @Param buf:   Block.
+ * @Param len:   Number of bytes.
+ * @Param expected_crc: Expected CRC32.
+ *
+ */
+#define UCUNIT_CheckCrc32Equal(buf, len, expected_crc)                  \
+    do                                                                  \
+    {                                                                   \
+        UCUNIT_DefineSite(ucunit_site, "Crc32Equal",                    \
+                          #buf "," #len "," #expected_crc);             \
+        unsigned long ucunit_expected = (unsigned long)(expected_crc);  \
+        unsigned long ucunit_actual = UCUNIT_Crc32((buf), (len));       \
+        UCUNIT_CheckSiteValues( (ucunit_expected == ucunit_actual) ? 1 : 0, \
+                                &ucunit_site, UCUNIT_VALUE_HEX,         \
+                                ucunit_expected, ucunit_actual );       \
+    } while(0)
+
+/**
+ * @Macro:       UCUNIT_DigestBegin()
+ *
+ * @Description: Starts a CRC32 digest of data that is checked in
+ *               several blocks, e.g. a stream that does not fit
+ *               into RAM.
+ *
+ */
+#define UCUNIT_DigestBegin()    (ucunit_state.digest = 0)
+
+/**
+ * @Macro:       UCUNIT_DigestUpdate(data, len)
+ *
+ * @Description: Adds a block to the digest.
+ *
+ * @Param data:  Block.
+ * @Param len:   Number of bytes.
+ *
+ */
+#define UCUNIT_DigestUpdate(data, len)                                  \
+    (ucunit_state.digest = UCUNIT_Crc32Update(ucunit_state.digest, (data), (len)))
+
+/**
+ * @Macro:       UCUNIT_DigestCheck(expected_crc)
+ *
+ * @Description: Checks the CRC32 of all blocks since
+ *               UCUNIT_DigestBegin(). Both CRCs are reported in hex.
+ *
+ * @Param expected_crc: Expected CRC32.
+ *
+ */
+#define UCUNIT_DigestCheck(expected_crc)                                \
+    do                                                                  \
+    {                                                                   \
+        UCUNIT_DefineSite(ucunit_site, "DigestCheck", #expected_crc);   \
+        unsigned long ucunit_expected = (unsigned long)(expected_crc);  \
+        UCUNIT_CheckSiteValues( (ucunit_expected == ucunit_state.digest) ? 1 : 0, \
+                                &ucunit_site, UCUNIT_VALUE_HEX,         \
+                                ucunit_expected, ucunit_state.digest ); \
+    } while(0)
+
+/*****************************************************************************/
+/* Floating Point and Fixed Point Checks                                     */
+/*****************************************************************************/
+
+#ifndef UCUNIT_NO_FLOAT
+/**
+ * @Function:    UCUNIT_CheckNearSite(site, expected, actual, abs_tol)
+ *
+ * @Description: Passes if |expected - actual| <= abs_tol. Reports
+ *               both values.
+ *
+ * @Remarks:     This function is used by UCUNIT_CheckIsNear().
+ *
+ */
+void UCUNIT_CheckNearSite(const ucunit_site_t * site, double expected,
+                          double actual, double abs_tol);
+
+/**
+ * @Function:    UCUNIT_CheckUlpSite(site, expected, actual, max_ulps)
+ *
+ * @Description: Passes if expected and actual are at most max_ulps
+ *               representable floats apart. Reports both values.
+ *
+ * @Remarks:     This function is used by UCUNIT_CheckIsNearUlp().
+ *
+ */
+void UCUNIT_CheckUlpSite(const ucunit_site_t * site, float expected,
+                         float actual, unsigned long max_ulps);
+
+/**
+ * @Function:    UCUNIT_CheckArrayNearSite(site, expected, actual, n, abs_tol)
+ *
+ * @Description: Passes if |expected[i] - actual[i]| <= abs_tol for all
+ *               n samples. A failed check reports the maximum error
+ *               and its index.
+ *
+ * @Remarks:     This function is used by UCUNIT_CheckArrayIsNear().
+ *               Uses SSE2 if available.
+ *
+ */
+void UCUNIT_CheckArrayNearSite(const ucunit_site_t * site, const float * expected,
+                               const float * actual, size_t n, float abs_tol);
+
+/**
+ * @Macro:       UCUNIT_CheckIsNear(expected, actual, abs_tol)
+ *
+ * @Description: Checks if a floating point value is within an absolute
+ *               tolerance of the expected value.
+ *
+ * @Param expected: Expected value.
+ * @Param actual:   Actual value.
+ * @Param abs_tol:  Max. absolute difference.
+ *
+ */
+#define UCUNIT_CheckIsNear(expected, actual, abs_tol)                   \
+    do                                                                  \
+    {                                                                   \
+        UCUNIT_DefineSite(ucunit_site, "IsNear",                        \
+                          #expected "," #actual "," #abs_tol);          \
+        UCUNIT_CheckNearSite(&ucunit_site, (expected), (actual), (abs_tol)); \
+    } while(0)
+
+/**
+ * @Macro:       UCUNIT_CheckIsNearUlp(expected, actual, max_ulps)
+ *
+ * @Description: Checks if two floats differ by at most max_ulps units
+ *               in the last place. NaN never passes.
+ *
+ * @Param expected: Expected value.
+ * @Param actual:   Actual value.
+ * @Param max_ulps: Max. distance in ULPs.
+ *
+ */
+#define UCUNIT_CheckIsNearUlp(expected, actual, max_ulps)               \
+    do                                                                  \
+    {                                                                   \
+        UCUNIT_DefineSite(ucunit_site, "IsNearUlp",                     \
+                          #expected "," #actual "," #max_ulps);         \
+        UCUNIT_CheckUlpSite(&ucunit_site, (expected), (actual), (max_ulps)); \
+    } while(0)
+
+/**
+ * @Macro:       UCUNIT_CheckArrayIsNear(expected, actual, n, abs_tol)
+ *
+ * @Description: Checks two float arrays sample by sample. This counts
+ *               as one check.
+ *
+ * @Param expected: Expected samples.
+ * @Param actual:   Actual samples.
+ * @Param n:        Number of samples.
+ * @Param abs_tol:  Max. absolute difference of a sample.
+ *
+ */
+#define UCUNIT_CheckArrayIsNear(expected, actual, n, abs_tol)           \
+    do                                                                  \
+    {                                                                   \
+        UCUNIT_DefineSite(ucunit_site, "ArrayIsNear",                   \
+                          #expected "," #actual "," #n "," #abs_tol);   \
+        UCUNIT_CheckArrayNearSite(&ucunit_site, (expected), (actual),   \
+                                  (n), (abs_tol));                      \
+    } while(0)
+#endif
+
+/**
+ * @Function:    UCUNIT_CheckFixedNearSite(site, expected, actual, tol)
+ *
+ * @Description: Passes if |expected - actual| <= tol, for Q15 and Q31
+ *               values. Reports both values.
+ *
+ * @Remarks:     This function is used by UCUNIT_CheckQ15IsNear() and
+ *               UCUNIT_CheckQ31IsNear().
+ *
+ */
+void UCUNIT_CheckFixedNearSite(const ucunit_site_t * site, long expected,
+                               long actual, unsigned long tol);
+
+/**
+ * @Function:    UCUNIT_CheckQ15ArrayNearSite(site, expected, actual, n, tol)
+ *
+ * @Description: Passes if |expected[i] - actual[i]| <= tol for all
+ *               n Q15 samples. A failed check reports the maximum
+ *               error and its index.
+ *
+ * @Remarks:     This function is used by UCUNIT_CheckQ15ArrayIsNear().
+ *               Uses SSE2 if available.
+ *
+ */
+void UCUNIT_CheckQ15ArrayNearSite(const ucunit_site_t * site, const ucunit_q15_t * expected,
+                                  const ucunit_q15_t * actual, size_t n, unsigned long tol);
+
+/**
+ * @Function:    UCUNIT_CheckQ31ArrayNearSite(site, expected, actual, n, tol)
+ *
+ * @Description: Same as UCUNIT_CheckQ15ArrayNearSite() for Q31 samples.
+ *
+ * @Remarks:     This function is used by UCUNIT_CheckQ31ArrayIsNear().
+ *
+ */
+void UCUNIT_CheckQ31ArrayNearSite(const ucunit_site_t * site, const ucunit_q31_t * expected,
+                                  const ucunit_q31_t * actual, size_t n, unsigned long tol);
+
+/**
+ * @Macro:       UCUNIT_CheckQ15IsNear(expected, actual, tol)
+ *
+ * @Description: Checks if a Q15 value is within tol LSBs of the
+ *               expected value.
+ *
+ * @Param expected: Expected value.
+ * @Param actual:   Actual value.
+ * @Param tol:      Max. difference in LSBs.
+ *
+ */
+#define UCUNIT_CheckQ15IsNear(expected, actual, tol)                    \
+    do                                                                  \
+    {                                                                   \
+        UCUNIT_DefineSite(ucunit_site, "Q15IsNear",                     \
+                          #expected "," #actual "," #tol);              \
+        UCUNIT_CheckFixedNearSite(&ucunit_site, (ucunit_q15_t)(expected), \
+                                  (ucunit_q15_t)(actual), (tol));       \
+    } while(0)
+
+/**
+ * @Macro:       UCUNIT_CheckQ31IsNear(expected, actual, tol)
+ *
+ * @Description: Checks if a Q31 value is within tol LSBs of the
+ *               expected value.
+ *
+ * @Param expected: Expected value.
+ * @Param actual:   Actual value.
+ * @Param tol:      Max. difference in LSBs.
+ *
+ */
+#define UCUNIT_CheckQ31IsNear(expected, actual, tol)                    \
+    do                                                                  \
+    {                                                                   \
+        UCUNIT_DefineSite(ucunit_site, "Q31IsNear",                     \
+                          #expected "," #actual "," #tol);              \
+        UCUNIT_CheckFixedNearSite(&ucunit_site, (ucunit_q31_t)(expected), \
+                                  (ucunit_q31_t)(actual), (tol));       \
+    } while(0)
+
+/**
+ * @Macro:       UCUNIT_CheckQ15ArrayIsNear(expected, actual, n, tol)
+ *
+ * @Description: Checks two Q15 arrays sample by sample. This counts
+ *               as one check.
+ *
+ * @Param expected: Expected samples.
+ * @Param actual:   Actual samples.
+ * @Param n:        Number of samples.
+ * @Param tol:      Max. difference of a sample in LSBs.
+ *
+ */
+#define UCUNIT_CheckQ15ArrayIsNear(expected, actual, n, tol)            \
+    do                                                                  \
+    {                                                                   \
+        UCUNIT_DefineSite(ucunit_site, "Q15ArrayIsNear",                \
+                          #expected "," #actual "," #n "," #tol);       \
+        UCUNIT_CheckQ15ArrayNearSite(&ucunit_site, (expected), (actual), \
+                                     (n), (tol));                       \
+    } while(0)
+
+/**
+ * @Macro:       UCUNIT_CheckQ31ArrayIsNear(expected, actual, n, tol)
+ *
+ * @Description: Checks two Q31 arrays sample by sample. This counts
+ *               as one check.
+ *
+ * @Param expected: Expected samples.
+ * @Param actual:   Actual samples.
+ * @Param n:        Number of samples.
+ * @Param tol:      Max. difference of a sample in LSBs.
+ *
+ */
+#define UCUNIT_CheckQ31ArrayIsNear(expected, actual, n, tol)            \
+    do                                                                  \
+    {                                                                   \
+        UCUNIT_DefineSite(ucunit_site, "Q31ArrayIsNear",                \
+                          #expected "," #actual "," #n "," #tol);       \
+        UCUNIT_CheckQ31ArrayNearSite(&ucunit_site, (expected), (actual), \
+                                     (n), (tol));                       \
+    } while(0)
+
+/*****************************************************************************/
+/* Timing Checks                                                             */
+/*****************************************************************************/
+
+/**
+ * @Function:    UCUNIT_MicrosecondsToTicks(us)
+ *
+ * @Description: Converts a time in microseconds into ticks of
+ *               UCUNIT_GetTicks().
+ *
+ * @Param us:    Time in microseconds.
+ *
+ * @Return:      Number of ticks, rounded up.
+ *
+ */
+System_Ticks UCUNIT_MicrosecondsToTicks(unsigned long us);
+
+/**
+ * @Macro:       UCUNIT_CheckDurationBelow(max_ticks, stmt)
+ *
+ * @Description: Checks that a statement does not take longer than
+ *               max_ticks ticks of UCUNIT_GetTicks().
+ *
+ * @Param max_ticks: Time budget in ticks.
+ * @Param stmt:  Statement to measure. Enclose statements containing
+ *               a comma in parentheses.
+ *
+ * @Remarks:     This macro uses UCUNIT_Check(condition, msg, args).
+ *
+ */
+#define UCUNIT_CheckDurationBelow(max_ticks, stmt)                      \
+    do                                                                  \
+    {                                                                   \
+        System_Ticks ucunit_start = UCUNIT_GetTicks();                  \
+        System_Ticks ucunit_elapsed;                                    \
+        stmt;                                                           \
+        ucunit_elapsed = UCUNIT_GetTicks() - ucunit_start;              \
+        UCUNIT_Check( ucunit_elapsed <= (System_Ticks)(max_ticks),      \
+                      "DurationBelow", #max_ticks "," #stmt );          \
+    } while(0)
+
+/**
+ * @Macro:       UCUNIT_CheckDurationBelowUs(max_us, stmt)
+ *
+ * @Description: Checks that a statement does not take longer than
+ *               max_us microseconds.
+ *
+ * @Param max_us: Time budget in microseconds.
+ * @Param stmt:  Statement to measure. Enclose statements containing
+ *               a comma in parentheses.
+ *
+ * @Remarks:     This macro uses UCUNIT_Check(condition, msg, args).
+ *               The budget is converted into ticks before the
+ *               measurement starts.
+ *
+ */
+#define UCUNIT_CheckDurationBelowUs(max_us, stmt)                       \
+    do                                                                  \
+    {                                                                   \
+        System_Ticks ucunit_budget = UCUNIT_MicrosecondsToTicks(max_us); \
+        System_Ticks ucunit_start = UCUNIT_GetTicks();                  \
+        System_Ticks ucunit_elapsed;                                    \
+        stmt;                                                           \
+        ucunit_elapsed = UCUNIT_GetTicks() - ucunit_start;              \
+        UCUNIT_Check( ucunit_elapsed <= ucunit_budget,                  \
+                      "DurationBelowUs", #max_us "," #stmt );           \
+    } while(0)
+
+/*****************************************************************************/
+/* Testcases */
+/*****************************************************************************/
+
+#ifdef UCUNIT_MODE_TOKENIZED
+#define UCUNIT_WriteTestcaseBegin(name)                          \
+    UCUNIT_WriteToken(UCUNIT_TOKEN_TESTCASE_BEGIN)
+#define UCUNIT_WriteTestcasePassed()                             \
+    UCUNIT_WriteToken(UCUNIT_TOKEN_TESTCASE_PASSED)
+#define UCUNIT_WriteTestcaseFailed()                             \
+    UCUNIT_WriteToken(UCUNIT_TOKEN_TESTCASE_FAILED)
+#define UCUNIT_WriteTestcaseSeparator()
+#elif defined(UCUNIT_REPORTERS)
+#define UCUNIT_WriteTestcaseBegin(name)                          \
+    UCUNIT_ReportTestcaseBegin(name)
+#define UCUNIT_WriteTestcasePassed()                             \
+    UCUNIT_ReportTestcaseEnd(NULL)
+#define UCUNIT_WriteTestcaseFailed()                             \
+    do                                                           \
+    {                                                            \
+        UCUNIT_DefineSite(ucunit_site, "EndTestcase", "");       \
+        UCUNIT_ReportTestcaseEnd(&ucunit_site);                  \
+    } while(0)
+#define UCUNIT_WriteTestcaseSeparator()                          \
+    UCUNIT_ReportTestcaseSeparator()
+#else
+/**
+ * @Macro:       UCUNIT_WriteTestcaseBegin(name)
+ *
+ * @Description: Writes the header of a test case.
+ *
+ * @Param name:  Name of the test case.
+ *
+ * @Remarks:     This macro is used by UCUNIT_TestcaseBegin(name).
+ *
+ */
+#define UCUNIT_WriteTestcaseBegin(name)                                   \
+    do                                                                    \
+    {                                                                     \
+        UCUNIT_WriteString_P(UCUNIT_PSTR("\n=============================" \
+                                         "=========\n"));                  \
+        UCUNIT_WriteString(name);                                         \
+        UCUNIT_WriteString_P(UCUNIT_PSTR("\n=============================" \
+                                         "=========\n"));                  \
+    }                                                                     \
+    while(0)
+
+/**
+ * @Macro:       UCUNIT_WriteTestcasePassed()
+ *
+ * @Description: Writes that a test case has passed.
+ *
+ * @Remarks:     This macro is used by UCUNIT_TestcaseEnd().
+ *
+ */
+#define UCUNIT_WriteTestcasePassed()                             \
+    UCUNIT_WriteString_P(UCUNIT_PSTR("Testcase passed.\n"))
+
+/**
+ * @Macro:       UCUNIT_WriteTestcaseFailed()
+ *
+ * @Description: Writes that a test case has failed.
+ *
+ * @Remarks:     This macro is used by UCUNIT_TestcaseEnd().
+ *
+ */
+#define UCUNIT_WriteTestcaseFailed()                             \
+    UCUNIT_WriteFailedMsg("EndTestcase","")
+
+/**
+ * @Macro:       UCUNIT_WriteTestcaseSeparator()
+ *
+ * @Description: Writes the separator line around a test case result.
+ *
+ * @Remarks:     This macro is used by UCUNIT_TestcaseEnd().
+ *
+ */
+#define UCUNIT_WriteTestcaseSeparator()                          \
+    UCUNIT_WriteString_P(UCUNIT_PSTR("======================================\n"))
+#endif
+
+/**
+ * @Macro:       UCUNIT_TestcaseBegin(name)
+ *
+ * @Description: Marks the beginning of a test case and resets
+ *               the test case statistic.
+ *
+ * @Param name:  Name of the test case.
+ *
+ * @Remarks:     This macro uses UCUNIT_WriteString(msg) to print the name.
+ *
+ */
+#define UCUNIT_TestcaseBegin(name)                                        \
+    UCUNIT_TestcaseBeginDeadline(name, 0)
+
+/**
+ * @Macro:       UCUNIT_TestcaseBeginDeadline(name, max_ticks)
+ *
+ * @Description: Marks the beginning of a test case with a deadline.
+ *               UCUNIT_TestcaseEnd() fails the test case if it takes
+ *               longer than max_ticks ticks of UCUNIT_GetTicks().
+ *
+ * @Param name:  Name of the test case.
+ * @Param max_ticks: Deadline in ticks, 0 for none. Use
+ *               UCUNIT_MicrosecondsToTicks(us) for a deadline in
+ *               microseconds.
+ *
+ * @Remarks:     This macro uses UCUNIT_WriteString(msg) to print the name.
+ *
+ */
+#define UCUNIT_TestcaseBeginDeadline(name, max_ticks)                     \
+    UCUNIT_TestcaseBeginLimits(name, max_ticks, UCUNIT_TESTCASE_TIMEOUT)
+
+#ifdef UCUNIT_TIMEOUTS
+#define UCUNIT_TESTCASE_TIMEOUT ucunit_state.testcase_timeout
+#else
+#define UCUNIT_TESTCASE_TIMEOUT 0
+#endif
+
+/**
+ * @Macro:       UCUNIT_TestcaseBeginTimeout(name, ms)
+ *
+ * @Description: Marks the beginning of a test case with a timeout.
+ *               If the test case hangs, it is stopped after ms
+ *               milliseconds and fails with the elapsed time.
+ *
+ * @Param name:  Name of the test case.
+ * @Param ms:    Timeout in milliseconds, 0 for none.
+ *
+ * @Remarks:     This macro is only available with UCUNIT_TIMEOUTS.
+ *
+ */
+#define UCUNIT_TestcaseBeginTimeout(name, ms)                             \
+    UCUNIT_TestcaseBeginLimits(name, 0, ms)
+
+/**
+ * @Macro:       UCUNIT_SetTestcaseTimeout(ms)
+ *
+ * @Description: Sets the timeout of the test cases that begin later
+ *               with UCUNIT_TestcaseBegin() or
+ *               UCUNIT_TestcaseBeginDeadline().
+ *
+ * @Param ms:    Timeout in milliseconds, 0 for none.
+ *
+ * @Remarks:     This macro is only available with UCUNIT_TIMEOUTS.
+ *
+ */
+#define UCUNIT_SetTestcaseTimeout(ms)                                     \
+    (ucunit_state.testcase_timeout = (unsigned long)(ms))
+
+/**
+ * @Macro:       UCUNIT_TestcaseBeginLimits(name, max_ticks, ms)
+ *
+ * @Description: Marks the beginning of a test case with a deadline
+ *               and a timeout. The deadline is checked when the test
+ *               case ends, the timeout stops a test case that hangs.
+ *
+ * @Param name:  Name of the test case.
+ * @Param max_ticks: Deadline in ticks, 0 for none.
+ * @Param ms:    Timeout in milliseconds, 0 for none. Ignored without
+ *               UCUNIT_TIMEOUTS.
+ *
+ * @Remarks:     This macro uses UCUNIT_WriteString(msg) to print the name.
+ *
+ */
+#define UCUNIT_TestcaseBeginLimits(name, max_ticks, ms)                   \
+    do                                                                    \
+    {                                                                     \
+        UCUNIT_WriteTestcaseBegin(name);                                  \
+        ucunit_state.testcases_failed_checks = ucunit_state.statistics.checks_failed; \
+        ucunit_state.testcase_deadline = (System_Ticks)(max_ticks);       \
+        ucunit_state.testcase_start = UCUNIT_GetTicks();                  \
+        UCUNIT_ArmTimeout(ms);                                            \
+    }                                                                     \
+    while(0)
+
+#ifdef UCUNIT_TIMEOUTS
+void UCUNIT_ArmTimeout(unsigned long ms);
+void UCUNIT_DisarmTimeout(void);
+#else
+#define UCUNIT_ArmTimeout(ms) ((void)(ms))
+#define UCUNIT_DisarmTimeout() do { } while(0)
+#endif
+
+/**
+ * @Macro:       UCUNIT_TestcaseEnd()
+ *
+ * @Description: Marks the end of a test case and calculates
+ *               the test case statistics. If the test case was started
+ *               with a deadline, the elapsed time is checked first.
+ *               A running testcase timeout is stopped.
+ *               In UCUNIT_MODE_DEFERRED the log is written here.
+ *
+ * @Remarks:     This macro uses UCUNIT_WriteString(msg) to print the result.
+ *
+ */
+#define UCUNIT_TestcaseEnd()                                         \
+    do                                                               \
+    {                                                                \
+        UCUNIT_DisarmTimeout();                                      \
+        if (0 != ucunit_state.testcase_deadline)                     \
+        {                                                            \
+            UCUNIT_Check( (UCUNIT_GetTicks() - ucunit_state.testcase_start) \
+                          <= ucunit_state.testcase_deadline,         \
+                          "TestcaseDeadline", "" );                  \
+        }                                                            \
+        UCUNIT_FlushDeferred();                                      \
+        UCUNIT_WriteTestcaseSeparator();                             \
+        if( 0==(ucunit_state.testcases_failed_checks - ucunit_state.statistics.checks_failed) ) \
+        {                                                            \
+            UCUNIT_WriteTestcasePassed();                            \
+            ucunit_state.statistics.testcases_passed++;              \
+        }                                                            \
+        else                                                         \
+        {                                                            \
+            UCUNIT_WriteTestcaseFailed();                            \
+            UCUNIT_FlushDeferred();                                  \
+            ucunit_state.statistics.testcases_failed++;              \
+        }                                                            \
+        UCUNIT_WriteTestcaseSeparator();                             \
+    }                                                                \
+    while(0)
+
+/*****************************************************************************/
+/* Support for code coverage */
+/*****************************************************************************/
+
+/**
+ * @Function:    UCUNIT_CountCoveredTracepoints(first, last)
+ *
+ * @Description: Counts the covered trace points in a range.
  *
- * @Param value: Value to check.
- * @Param lower: Lower bound.
- * @Param upper: Upper bound.
+ * @Param first: Index of the first trace point.
+ * @Param last:  Index of the last trace point (inclusive).
  *
- * @Remarks:     This macro uses UCUNIT_Check(condition, msg, args).
+ * @Return:      Number of covered trace points.
+ *
+ * @Remarks:     The coverage bitmap is counted a word at a time.
+ *               Indices >= UCUNIT_MAX_TRACEPOINTS are ignored.
  *
  */
-#define UCUNIT_CheckIsInRange(value, lower, upper)   \
-    UCUNIT_Check( ( (value>=lower) && (value<=upper) ), "IsInRange", #value "," #lower "," #upper)
+int UCUNIT_CountCoveredTracepoints(int first, int last);
 
 /**
- * @Macro:       UCUNIT_CheckIs8Bit(value)
+ * @Function:    UCUNIT_WriteTracepointCoverage(first, last)
  *
- * @Description: Checks if a value fits into 8-bit.
- *
- * @Param value: Value to check.
+ * @Description: Writes how many trace points of a range are covered,
+ *               e.g. "Tracepoints 0..15: covered: 12 of 16".
  *
- * @Remarks:     This macro uses UCUNIT_Check(condition, msg, args).
+ * @Param first: Index of the first trace point.
+ * @Param last:  Index of the last trace point (inclusive).
  *
  */
-#define UCUNIT_CheckIs8Bit(value)                      \
-    UCUNIT_Check( value==(value & 0xFF), "Is8Bit", #value )
+void UCUNIT_WriteTracepointCoverage(int first, int last);
 
 /**
- * @Macro:       UCUNIT_CheckIs16Bit(value)
+ * @Function:    UCUNIT_WriteTracepointReport(first, last)
  *
- * @Description: Checks if a value fits into 16-bit.
+ * @Description: Writes the hit count of each covered trace point
+ *               and the list of uncovered trace points of a range.
  *
- * @Param value: Value to check.
+ * @Param first: Index of the first trace point.
+ * @Param last:  Index of the last trace point (inclusive).
  *
- * @Remarks:     This macro uses UCUNIT_Check(condition, msg, args).
+ * @Remarks:     Saturated counters are written with a trailing '+'.
+ *               Without UCUNIT_TRACEPOINT_COUNTERS only the uncovered
+ *               trace points are written.
  *
  */
-#define UCUNIT_CheckIs16Bit(value)                     \
-    UCUNIT_Check( value==(value & 0xFFFF), "Is16Bit", #value )
+void UCUNIT_WriteTracepointReport(int first, int last);
 
+#ifdef UCUNIT_TRACEPOINT_COUNTERS
 /**
- * @Macro:       UCUNIT_CheckIs32Bit(value)
+ * @Macro:       UCUNIT_CountTracepointHit(index)
  *
- * @Description: Checks if a value fits into 32-bit.
+ * @Description: Increments the hit counter of a trace point. The
+ *               counter stops at UCUNIT_HITS_MAX.
  *
- * @Param value: Value to check.
+ * @Param index: Index of the trace point.
  *
- * @Remarks:     This macro uses UCUNIT_Check(condition, msg, args).
+ * @Remarks:     This macro is used by UCUNIT_Tracepoint(index).
  *
  */
-#define UCUNIT_CheckIs32Bit(value)                     \
-    UCUNIT_Check( value==(value & 0xFFFFFFFF), "Is32Bit", #value )
+#define UCUNIT_CountTracepointHit(index)                 \
+    do                                                   \
+    {                                                    \
+        if (ucunit_state.hits[index] != UCUNIT_HITS_MAX) \
+        {                                                \
+            ucunit_state.hits[index]++;                  \
+        }                                                \
+    } while(0)
 
 /**
- * Checks if bit is set
- */
-/**
- * @Macro:       UCUNIT_CheckIsBitSet(value, bitno)
- *
- * @Description: Checks if a bit is set in value.
+ * @Macro:       UCUNIT_GetTracepointHits(index)
  *
- * @Param value: Value to check.
- * @Param bitno: Bit number. The least significant bit is 0.
+ * @Description: Returns how often a trace point was executed.
  *
- * @Remarks:     This macro uses UCUNIT_Check(condition, msg, args).
+ * @Param index: Index of the trace point.
  *
  */
-#define UCUNIT_CheckIsBitSet(value, bitno) \
-    UCUNIT_Check( (1==(((value)>>(bitno)) & 0x01) ), "IsBitSet", #value "," #bitno)
+#define UCUNIT_GetTracepointHits(index)    (ucunit_state.hits[index])
+#else
+#define UCUNIT_CountTracepointHit(index)
+#endif
 
+#ifdef UCUNIT_TRACEPOINT_TIMESTAMPS
 /**
- * @Macro:       UCUNIT_CheckIsBitClear(value, bitno)
+ * @Macro:       UCUNIT_TraceTimestamp(index)
  *
- * @Description: Checks if a bit is not set in value.
+ * @Description: Writes the index of a trace point and the tick counter
+ *               into the trace buffer.
  *
- * @Param value: Value to check.
- * @Param bitno: Bit number. The least significant bit is 0.
+ * @Param index: Index of the trace point.
  *
- * @Remarks:     This macro uses UCUNIT_Check(condition, msg, args).
+ * @Remarks:     This macro is used by UCUNIT_Tracepoint(index).
  *
  */
-#define UCUNIT_CheckIsBitClear(value, bitno) \
-    UCUNIT_Check( (0==(((value)>>(bitno)) & 0x01) ), "IsBitClear", #value "," #bitno)
+#define UCUNIT_TraceTimestamp(index)                                   \
+    do                                                                 \
+    {                                                                  \
+        ucunit_trace_entry_t * ucunit_entry = &ucunit_state.trace[     \
+            ucunit_state.trace_next & (UCUNIT_TRACE_BUFFER_SIZE - 1)]; \
+        ucunit_entry->ticks = UCUNIT_GetTicks();                       \
+        ucunit_entry->tracepoint = (unsigned short)(index);            \
+        ucunit_state.trace_next++;                                     \
+    } while(0)
 
-/*****************************************************************************/
-/* Testcases */
-/*****************************************************************************/
+/**
+ * @Macro:       UCUNIT_ResetTrace()
+ *
+ * @Description: Removes all entries from the trace buffer.
+ *
+ */
+#define UCUNIT_ResetTrace()    (ucunit_state.trace_next = 0)
 
 /**
- * @Macro:       UCUNIT_TestcaseBegin(name)
+ * @Function:    UCUNIT_GetLatencyBetween(a, b, latency)
  *
- * @Description: Marks the beginning of a test case and resets
- *               the test case statistic.
+ * @Description: Measures the latencies from trace point a to trace
+ *               point b in the trace buffer. Each hit of b is paired
+ *               with the latest hit of a before it, each hit of a is
+ *               used once.
  *
- * @Param name:  Name of the test case.
+ * @Param a:       Index of the first trace point.
+ * @Param b:       Index of the second trace point.
+ * @Param latency: Returns min, max, sum and number of latencies.
  *
- * @Remarks:     This macro uses UCUNIT_WriteString(msg) to print the name.
+ * @Return:      Number of latencies found.
  *
  */
-#define UCUNIT_TestcaseBegin(name)                                        \
-    do                                                                    \
-    {                                                                     \
-        UCUNIT_WriteString("\n======================================\n"); \
-        UCUNIT_WriteString(name);                                         \
-        UCUNIT_WriteString("\n======================================\n"); \
-        ucunit_testcases_failed_checks = ucunit_checks_failed;            \
-    }                                                                     \
-    while(0)
+unsigned long UCUNIT_GetLatencyBetween(int a, int b, ucunit_latency_t * latency);
 
 /**
- * @Macro:       UCUNIT_TestcaseEnd()
+ * @Function:    UCUNIT_WriteTraceReport()
  *
- * @Description: Marks the end of a test case and calculates
- *               the test case statistics.
+ * @Description: Writes min, max and mean latency of every transition
+ *               between two successive entries of the trace buffer,
+ *               e.g. "  1->2: samples: 4 min: 10 max: 12 mean: 11 ticks".
  *
- * @Remarks:     This macro uses UCUNIT_WriteString(msg) to print the result.
+ * @Remarks:     The report does not change the trace buffer.
  *
  */
-#define UCUNIT_TestcaseEnd()                                         \
-    do                                                               \
-    {                                                                \
-        UCUNIT_WriteString("======================================\n");  \
-        if( 0==(ucunit_testcases_failed_checks - ucunit_checks_failed) ) \
-        {                                                            \
-            UCUNIT_WriteString("Testcase passed.\n");                \
-            ucunit_testcases_passed++;                               \
-        }                                                            \
-        else                                                         \
-        {                                                            \
-            UCUNIT_WriteFailedMsg("EndTestcase","");                 \
-            ucunit_testcases_failed++;                               \
-        }                                                            \
-        UCUNIT_WriteString("======================================\n"); \
-    }                                                                \
-    while(0)
+void UCUNIT_WriteTraceReport(void);
 
-/*****************************************************************************/
-/* Support for code coverage */
-/*****************************************************************************/
+/**
+ * @Macro:       UCUNIT_CheckLatencyBetween(a, b, max_ticks)
+ *
+ * @Description: Checks that trace point b was reached after trace
+ *               point a, and that no latency from a to b in the trace
+ *               buffer exceeds max_ticks.
+ *
+ * @Param a:         Index of the first trace point.
+ * @Param b:         Index of the second trace point.
+ * @Param max_ticks: Max. latency in ticks.
+ *
+ * @Remarks:     Requires UCUNIT_TRACEPOINT_TIMESTAMPS.
+ *
+ */
+#define UCUNIT_CheckLatencyBetween(a, b, max_ticks)                     \
+    do                                                                  \
+    {                                                                   \
+        ucunit_latency_t ucunit_latency;                                \
+        UCUNIT_Check( (UCUNIT_GetLatencyBetween(a, b, &ucunit_latency) > 0) \
+                      && (ucunit_latency.max <= (System_Ticks)(max_ticks)), \
+                      "LatencyBetween", #a "," #b "," #max_ticks );     \
+    } while(0)
+#else
+#define UCUNIT_TraceTimestamp(index)
+#define UCUNIT_ResetTrace()
+#endif
 
 /**
  * @Macro:       UCUNIT_Tracepoint(index)
  *
  * @Description: Marks a trace point.
- *               If a trace point is executed, its coverage state switches
- *               from 0 to the line number.
-  *              If a trace point was never executed, the state
+ *               If a trace point is executed, its coverage bit is set.
+ *               If a trace point was never executed, the bit
  *               remains 0.
  *
  * @Param index: Index of the tracepoint.
  *
- * @Remarks:     This macro fails if index>UCUNIT_MAX_TRACEPOINTS.
+ * @Remarks:     This macro fails if index>=UCUNIT_MAX_TRACEPOINTS.
+ *               With a constant index this is a single OR operation.
  *
  */
 #define UCUNIT_Tracepoint(index)                         \
     if(index<UCUNIT_MAX_TRACEPOINTS)                     \
     {                                                    \
-        ucunit_checkpoints[index] = __LINE__;            \
+        ucunit_state.coverage[(index) / UCUNIT_COVERAGE_WORD_BITS] |= \
+            (ucunit_coverage_word_t)1 << ((index) % UCUNIT_COVERAGE_WORD_BITS); \
+        UCUNIT_CountTracepointHit(index);                \
+        UCUNIT_TraceTimestamp(index);                    \
     }                                                    \
     else                                                 \
     {                                                    \
@@ -619,18 +3117,38 @@ static int ucunit_index = 0; /* Tracepoint index */
 /**
  * @Macro:       UCUNIT_ResetTracepointCoverage()
  *
- * @Description: Resets the trace point coverage state to 0.
+ * @Description: Resets the coverage state of all trace points to 0.
  *
- * @Param index: Index of the trace point.
- *
- * @Remarks:     This macro fails if index>UCUNIT_MAX_TRACEPOINTS.
+ * @Remarks:     The coverage bitmap is cleared a word at a time.
+ *               The hit counters and the trace buffer are cleared,
+ *               too.
  *
  */
+#ifdef UCUNIT_TRACEPOINT_COUNTERS
+#define UCUNIT_ResetTracepointHits()                        \
+    do                                                      \
+    {                                                       \
+        int ucunit_tracepoint;                              \
+        for (ucunit_tracepoint=0; ucunit_tracepoint<UCUNIT_MAX_TRACEPOINTS; ucunit_tracepoint++) \
+        {                                                   \
+            ucunit_state.hits[ucunit_tracepoint]=0;         \
+        }                                                   \
+    } while(0)
+#else
+#define UCUNIT_ResetTracepointHits()
+#endif
+
 #define UCUNIT_ResetTracepointCoverage()                    \
-    for (ucunit_index=0; ucunit_index<UCUNIT_MAX_TRACEPOINTS; ucunit_index++) \
-    {                                                \
-        ucunit_checkpoints[ucunit_index]=0;          \
-    }
+    do                                                      \
+    {                                                       \
+        int ucunit_word;                                    \
+        for (ucunit_word=0; ucunit_word<UCUNIT_COVERAGE_WORDS; ucunit_word++) \
+        {                                                   \
+            ucunit_state.coverage[ucunit_word]=0;           \
+        }                                                   \
+        UCUNIT_ResetTracepointHits();                       \
+        UCUNIT_ResetTrace();                                \
+    } while(0)
 
 /**
  * @Macro:       UCUNIT_CheckTracepointCoverage(index)
@@ -643,7 +3161,324 @@ static int ucunit_index = 0; /* Tracepoint index */
  *
  */
 #define UCUNIT_CheckTracepointCoverage(index)    \
-    UCUNIT_Check( (ucunit_checkpoints[index]!=0), "TracepointCoverage", #index);
+    UCUNIT_Check( (0 != ((ucunit_state.coverage[(index) / UCUNIT_COVERAGE_WORD_BITS] \
+                          >> ((index) % UCUNIT_COVERAGE_WORD_BITS)) & 0x01)), \
+                  "TracepointCoverage", #index);
+
+/**
+ * @Macro:       UCUNIT_CheckTracepointRangeCoverage(first, last)
+ *
+ * @Description: Checks if all trace points of a range were covered.
+ *               This counts as one check.
+ *
+ * @Param first: Index of the first trace point.
+ * @Param last:  Index of the last trace point (inclusive).
+ *
+ * @Remarks:     This macro uses UCUNIT_CountCoveredTracepoints().
+ *
+ */
+#define UCUNIT_CheckTracepointRangeCoverage(first, last)    \
+    UCUNIT_Check( (UCUNIT_CountCoveredTracepoints(first, last) == ((last) - (first) + 1)), \
+                  "TracepointRangeCoverage", #first "," #last)
+
+/*****************************************************************************/
+/* Benchmarks                                                                */
+/*****************************************************************************/
+
+/**
+ * @Function:    UCUNIT_BenchmarkAddSample(benchmark, ticks)
+ *
+ * @Description: Adds a measured time to the benchmark statistics.
+ *
+ * @Param benchmark: Benchmark statistics.
+ * @Param ticks: Elapsed ticks. The measurement overhead is subtracted.
+ *
+ * @Remarks:     This function is used by UCUNIT_BenchmarkEnd().
+ *
+ */
+void UCUNIT_BenchmarkAddSample(ucunit_benchmark_t * benchmark, System_Ticks ticks);
+
+/**
+ * @Function:    UCUNIT_BenchmarkWriteReport(benchmark, name)
+ *
+ * @Description: Writes min/max/mean and the histogram of a benchmark
+ *               and resets its statistics.
+ *
+ * @Param benchmark: Benchmark statistics.
+ * @Param name:  Name of the benchmark.
+ *
+ * @Remarks:     This function is used by UCUNIT_BenchmarkReport(name).
+ *
+ */
+void UCUNIT_BenchmarkWriteReport(ucunit_benchmark_t * benchmark, char * name);
+
+/**
+ * @Macro:       UCUNIT_BenchmarkBegin()
+ *
+ * @Description: Starts a time measurement.
+ *
+ * @Remarks:     A measurement must be finished with UCUNIT_BenchmarkEnd().
+ *
+ */
+#define UCUNIT_BenchmarkBegin()                                     \
+    do                                                              \
+    {                                                               \
+        ucunit_state.benchmark.start = UCUNIT_GetTicks();           \
+    } while(0)
+
+/**
+ * @Macro:       UCUNIT_BenchmarkEnd()
+ *
+ * @Description: Stops a time measurement and adds the elapsed ticks
+ *               to the benchmark statistics.
+ *
+ * @Remarks:     A measurement must begin with UCUNIT_BenchmarkBegin().
+ *
+ */
+#define UCUNIT_BenchmarkEnd()                                       \
+    do                                                              \
+    {                                                               \
+        System_Ticks ucunit_ticks = UCUNIT_GetTicks();              \
+        UCUNIT_BenchmarkAddSample(&ucunit_state.benchmark,          \
+                                  ucunit_ticks - ucunit_state.benchmark.start); \
+    } while(0)
+
+/**
+ * @Macro:       UCUNIT_BenchmarkReport(name)
+ *
+ * @Description: Writes the statistics of all measurements since the
+ *               last report: number of samples, min, max, mean and
+ *               a histogram of the elapsed ticks.
+ *
+ * @Param name:  Name of the benchmark.
+ *
+ */
+#define UCUNIT_BenchmarkReport(name)                                \
+    UCUNIT_BenchmarkWriteReport(&ucunit_state.benchmark, name)
+
+/**
+ * @Macro:       UCUNIT_Benchmark(name, iterations, stmt)
+ *
+ * @Description: Measures a statement several times and writes
+ *               the statistics.
+ *
+ * @Param name:  Name of the benchmark.
+ * @Param iterations: Number of measurements.
+ * @Param stmt:  Statement to measure.
+ *
+ * @Remarks:     This macro uses UCUNIT_BenchmarkBegin(),
+ *               UCUNIT_BenchmarkEnd() and UCUNIT_BenchmarkReport(name).
+ *
+ */
+#define UCUNIT_Benchmark(name, iterations, stmt)                    \
+    do                                                              \
+    {                                                               \
+        unsigned long ucunit_iteration;                             \
+        for (ucunit_iteration = 0; ucunit_iteration < (unsigned long)(iterations); ucunit_iteration++) \
+        {                                                           \
+            UCUNIT_BenchmarkBegin();                                \
+            stmt;                                                   \
+            UCUNIT_BenchmarkEnd();                                  \
+        }                                                           \
+        UCUNIT_BenchmarkReport(name);                               \
+    } while(0)
+
+/*****************************************************************************/
+/* Test Registry                                                             */
+/*****************************************************************************/
+
+#if !defined(UCUNIT_TEST_TABLE) && \
+    !(defined(__GNUC__) && defined(__ELF__) && !defined(__AVR__))
+#define UCUNIT_TEST_TABLE
+#endif
+
+/**
+ * @Macro:       UCUNIT_TEST(name, tags)
+ *
+ * @Description: Defines and registers a test function. Use it instead
+ *               of the function head:
+ *
+ *                 UCUNIT_TEST(Test_Parser, "parser fast")
+ *                 {
+ *                     UCUNIT_TestcaseBegin("Parser");
+ *                     ...
+ *                 }
+ *
+ * @Param name:  Name of the test function.
+ * @Param tags:  String with tags separated by blanks, may be "".
+ *
+ * @Remarks:     The tests of a file are run in the order of their
+ *               lines, the files in the order of the linker. With
+ *               UCUNIT_TEST_TABLE the order of the table is used.
+ *
+ */
+#ifdef UCUNIT_TEST_TABLE
+#define UCUNIT_TEST(name, tags)                                         \
+    static void name(void);                                             \
+    UCUNIT_DeclareTest(name);                                           \
+    const ucunit_test_t ucunit_test_##name =                            \
+        { #name, tags, __FILE__, __LINE__, name };                      \
+    static void name(void)
+#else
+#define UCUNIT_TEST(name, tags)                                         \
+    static void name(void);                                             \
+    UCUNIT_DeclareTest(name);                                           \
+    const ucunit_test_t ucunit_test_##name =                            \
+        { #name, tags, __FILE__, __LINE__, name };                      \
+    static const ucunit_test_t * const ucunit_test_entry_##name         \
+        __attribute__((used, section("ucunit_tests"))) =                \
+        &ucunit_test_##name;                                            \
+    static void name(void)
+#endif
+
+/**
+ * @Macro:       UCUNIT_DeclareTest(name)
+ *
+ * @Description: Declares a test of another file for the test table.
+ *
+ * @Param name:  Name of the test function.
+ *
+ */
+#define UCUNIT_DeclareTest(name)                                        \
+    extern const ucunit_test_t ucunit_test_##name
+
+/**
+ * @Macro:       UCUNIT_TestTableBegin()
+ *
+ * @Description: Begins the table of all tests for UCUNIT_TEST_TABLE:
+ *
+ *                 UCUNIT_TestTableBegin()
+ *                     UCUNIT_TestTableEntry(Test_Parser)
+ *                     UCUNIT_TestTableEntry(Test_Scanner)
+ *                 UCUNIT_TestTableEnd()
+ *
+ * @Remarks:     Without UCUNIT_TEST_TABLE the table expands to
+ *               nothing, so it can be kept in the sources for both
+ *               kinds of targets.
+ *
+ */
+#ifdef UCUNIT_TEST_TABLE
+#define UCUNIT_TestTableBegin()                                         \
+    const ucunit_test_t * const ucunit_test_table[] = {
+#define UCUNIT_TestTableEntry(name)    &ucunit_test_##name,
+#define UCUNIT_TestTableEnd()          NULL };
+#else
+#define UCUNIT_TestTableBegin()
+#define UCUNIT_TestTableEntry(name)
+#define UCUNIT_TestTableEnd()
+#endif
+
+/**
+ * @Function:    UCUNIT_MatchTest(test, filter)
+ *
+ * @Description: Checks if a test matches a filter. The filter is a
+ *               list of words separated by blanks or commas:
+ *
+ *                 name     matches the name of the test
+ *                 @tag     matches a tag of the test
+ *                 -word    excludes the tests matching word
+ *
+ *               Names and tags may contain the wildcards * and ?.
+ *               A test matches if it matches one of the other words
+ *               and none of the excluding words. If there are only
+ *               excluding words, all other tests match.
+ *
+ * @Param test:   Registered test.
+ * @Param filter: Filter, an empty filter matches all tests.
+ *
+ * @Return:      TRUE if the test matches.
+ *
+ */
+int UCUNIT_MatchTest(const ucunit_test_t * test, const char * filter);
+
+/**
+ * @Function:    UCUNIT_ForEachTest(filter, visit, context)
+ *
+ * @Description: Calls a function for each registered test matching the
+ *               filter, in the order in which the tests are run.
+ *
+ * @Param filter:  Filter, see UCUNIT_MatchTest().
+ * @Param visit:   Function to call with the test and the context.
+ * @Param context: Passed to visit.
+ *
+ * @Return:      Number of matching tests.
+ *
+ */
+int UCUNIT_ForEachTest(const char * filter, ucunit_visitor_t visit, void * context);
+
+/**
+ * @Function:    UCUNIT_CountTests()
+ *
+ * @Return:      Number of registered tests.
+ *
+ */
+int UCUNIT_CountTests(void);
+
+/**
+ * @Function:    UCUNIT_RunTest(test)
+ *
+ * @Description: Runs a single registered test.
+ *
+ * @Param test:  Registered test.
+ *
+ * @Remarks:     With UCUNIT_CRASH_RECOVERY a crash of the test is
+ *               written with the signal and the last check site, and
+ *               counted as a failed check and a failed testcase.
+ *
+ */
+void UCUNIT_RunTest(const ucunit_test_t * test);
+
+/**
+ * @Function:    UCUNIT_ListTests(filter)
+ *
+ * @Description: Writes "file:line: name [tags]" for each registered
+ *               test matching the filter.
+ *
+ * @Param filter: Filter, see UCUNIT_MatchTest().
+ *
+ * @Return:      Number of matching tests.
+ *
+ */
+int UCUNIT_ListTests(const char * filter);
+
+#ifdef UCUNIT_PERSIST
+/**
+ * @Function:    UCUNIT_ClearPersistent()
+ *
+ * @Description: Discards the progress record of UCUNIT_PERSIST, so the
+ *               next call of UCUNIT_RunTests() starts with the first
+ *               test.
+ *
+ * @Remarks:     UCUNIT_RunTests() does this itself when all tests ran.
+ *
+ */
+void UCUNIT_ClearPersistent(void);
+#endif
+
+/**
+ * @Function:    UCUNIT_RunTests(command)
+ *
+ * @Description: Runs all registered tests matching a filter. The
+ *               filter may be preceded by these options:
+ *
+ *                 --list     only lists the tests with UCUNIT_ListTests()
+ *                 --jobs=N   runs the tests in N worker processes, see
+ *                            UCUNIT_PARALLEL. --jobs uses one per CPU.
+ *                 --report=R selects the reporter R, text, tap or junit,
+ *                            see UCUNIT_REPORTERS. --report=R:path
+ *                            writes the report to a file.
+ *
+ * @Param command: Options and filter, see UCUNIT_MatchTest().
+ *
+ * @Return:      Number of matching tests.
+ *
+ * @Remarks:     If the filter is not empty, the number of selected
+ *               tests is written first. With UCUNIT_PERSIST a run
+ *               interrupted by a reset is continued if the filter and
+ *               the number of tests are the same.
+ *
+ */
+int UCUNIT_RunTests(const char * command);
 
 /*****************************************************************************/
 /* Testsuite Summary                                                         */
@@ -654,22 +3489,71 @@ static int ucunit_index = 0; /* Tracepoint index */
  *
  * @Description: Writes the test suite summary.
  *
- * @Remarks:     This macro uses UCUNIT_WriteString(msg) and
- *               UCUNIT_WriteInt(n) to write the summary.
+ * @Remarks:     This macro uses UCUNIT_WriteString_P(msg) and
+ *               UCUNIT_WriteCounter(n) to write the summary.
+ *               In UCUNIT_MODE_TOKENIZED the four counters are
+ *               written as one summary record of 32-bit values.
+ *               With UCUNIT_TRACEPOINT_COUNTERS the tracepoint report
+ *               of all tracepoints is written first, with
+ *               UCUNIT_TRACEPOINT_TIMESTAMPS the trace report.
+ *               In UCUNIT_MODE_DEFERRED the log is written first.
+ *               With UCUNIT_REPORTERS the reporter ends its report
+ *               instead, see UCUNIT_ReportSummary().
  *
  */
+#ifdef UCUNIT_TRACEPOINT_COUNTERS
+#define UCUNIT_WriteSummaryHits()                                     \
+    UCUNIT_WriteTracepointReport(0, UCUNIT_MAX_TRACEPOINTS - 1)
+#else
+#define UCUNIT_WriteSummaryHits()
+#endif
+
+#ifdef UCUNIT_TRACEPOINT_TIMESTAMPS
+#define UCUNIT_WriteSummaryTrace()    UCUNIT_WriteTraceReport()
+#else
+#define UCUNIT_WriteSummaryTrace()
+#endif
+
+#define UCUNIT_WriteSummaryTracepoints()                              \
+    do                                                                \
+    {                                                                 \
+        UCUNIT_FlushDeferred();                                       \
+        UCUNIT_WriteSummaryHits();                                    \
+        UCUNIT_WriteSummaryTrace();                                   \
+    } while(0)
+
+#ifdef UCUNIT_MODE_TOKENIZED
+#define UCUNIT_WriteSummary()                                         \
+{                                                                     \
+    UCUNIT_WriteSummaryTracepoints();                                 \
+    UCUNIT_WriteByte(UCUNIT_TOKEN_SUMMARY);                           \
+    UCUNIT_WriteTokenU32(ucunit_state.statistics.testcases_failed);   \
+    UCUNIT_WriteTokenU32(ucunit_state.statistics.testcases_passed);   \
+    UCUNIT_WriteTokenU32(ucunit_state.statistics.checks_failed);      \
+    UCUNIT_WriteTokenU32(ucunit_state.statistics.checks_passed);      \
+    UCUNIT_FlushSink();                                               \
+}
+#else
 #define UCUNIT_WriteSummary()                                         \
 {                                                                     \
-    UCUNIT_WriteString("\n**************************************");   \
-    UCUNIT_WriteString("\nTestcases: failed: ");                      \
-    UCUNIT_WriteInt(ucunit_testcases_failed);                         \
-    UCUNIT_WriteString("\n           passed: ");                      \
-    UCUNIT_WriteInt(ucunit_testcases_passed);                         \
-    UCUNIT_WriteString("\nChecks:    failed: ");                      \
-    UCUNIT_WriteInt(ucunit_checks_failed);                            \
-    UCUNIT_WriteString("\n           passed: ");                      \
-    UCUNIT_WriteInt(ucunit_checks_passed);                            \
-    UCUNIT_WriteString("\n**************************************\n"); \
+    UCUNIT_WriteSummaryTracepoints();                                 \
+    if (!UCUNIT_ReportSummary())                                      \
+    {                                                                 \
+        UCUNIT_WriteString_P(UCUNIT_PSTR("\n************************" \
+                                         "**************"             \
+                                         "\nTestcases: failed: "));   \
+        UCUNIT_WriteCounter(ucunit_state.statistics.testcases_failed); \
+        UCUNIT_WriteString_P(UCUNIT_PSTR("\n           passed: "));   \
+        UCUNIT_WriteCounter(ucunit_state.statistics.testcases_passed); \
+        UCUNIT_WriteString_P(UCUNIT_PSTR("\nChecks:    failed: "));   \
+        UCUNIT_WriteCounter(ucunit_state.statistics.checks_failed);   \
+        UCUNIT_WriteString_P(UCUNIT_PSTR("\n           passed: "));   \
+        UCUNIT_WriteCounter(ucunit_state.statistics.checks_passed);   \
+        UCUNIT_WriteString_P(UCUNIT_PSTR("\n************************" \
+                                         "**************\n"));        \
+    }                                                                 \
+    UCUNIT_FlushSink();                                               \
 }
+#endif
 
 #endif /*UCUNIT_H_*/